@@ -0,0 +1,230 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+#include <hkos.h>
+
+// Set to 0 to run the same workload without preemption thresholds and
+// compare the number of context switches
+#ifndef BENCH_USE_THRESHOLD
+#define BENCH_USE_THRESHOLD     1
+#endif
+
+// Priorities of the tasks
+#define PRIO_FILTER_LOW         1
+#define PRIO_FILTER_HIGH        2
+#define PRIO_SENSOR             3
+#define PRIO_REPORT             4
+
+// Number of filter jobs running and number of times a filter job started
+// while the other one was running. The filters are in the same group, so
+// the second must stay at 0 when the thresholds are used.
+static volatile uint8_t filters_running = 0;
+static volatile uint16_t group_overlaps = 0;
+
+/**************************************************************************
+ * Helper function to blink both LEDs em case of error
+ *
+ * ************************************************************************/
+static void blink_error( void )
+{
+    while(1) {
+        hkos_gpio_toggle( 2 );
+        hkos_gpio_toggle( 14 );
+
+        hkos_sleep( 100 );
+    }
+}
+
+/**************************************************************************
+ * Helper function to keep the CPU busy
+ *
+ * We use attribute optmize O0 to prevent the busy wait from being
+ * optimized out.
+ *
+ * @param[in]   loops   number of iterations
+ *
+ * ************************************************************************/
+__attribute__((optimize("O0")))
+static void busy( uint16_t loops )
+{
+    for ( volatile uint16_t i = 0; i < loops; ++i );
+}
+
+/**************************************************************************
+ * Helper function to print an unsigned number
+ *
+ * @param[in]   value   number to be printed
+ *
+ * ************************************************************************/
+static void print_number( uint32_t value )
+{
+    char buffer[11];
+    char* p = &buffer[ sizeof(buffer) - 1 ];
+
+    *p = '\0';
+    do {
+        *--p = '0' + ( value % 10 );
+        value /= 10;
+    } while ( value > 0 );
+
+    hkos_serial_print( 0, p );
+}
+
+/**************************************************************************
+ * Helper function to run a filter job
+ *
+ * Counts the jobs that start while the other filter is in the middle of
+ * its job, which means one filter preempted the other.
+ *
+ * @param[in]   loops   number of iterations
+ *
+ * ************************************************************************/
+static void filter_job( uint16_t loops )
+{
+    if ( filters_running > 0 )
+        ++group_overlaps;
+    ++filters_running;
+
+    busy( loops );
+
+    --filters_running;
+}
+
+/**************************************************************************
+ * Filter tasks
+ *
+ * CPU bound jobs that run for several ticks before sleeping.
+ *
+ * ************************************************************************/
+static void filter_low( void )
+{
+    while(1) {
+        filter_job( 20000 );
+        hkos_sleep( 7 );
+    }
+}
+
+static void filter_high( void )
+{
+    while(1) {
+        filter_job( 15000 );
+        hkos_sleep( 5 );
+    }
+}
+
+/**************************************************************************
+ * Sensor task
+ *
+ * Short job released every 2 ms.
+ *
+ * ************************************************************************/
+static void sensor( void )
+{
+    hkos_tick_t last_wake = hkos_get_ticks();
+
+    while(1) {
+        hkos_gpio_toggle( 14 );
+        busy( 500 );
+        hkos_sleep_until( &last_wake, 2 );
+    }
+}
+
+/**************************************************************************
+ * Report task
+ *
+ * Prints the number of context switches of the last second and the
+ * number of times a filter preempted the other one.
+ *
+ * ************************************************************************/
+static void report( void )
+{
+    hkos_error_code_t error = hkos_serial_open( 0,
+                                                9600,
+                                                HKOS_SERIAL_DATA_8,
+                                                HKOS_SERIAL_STOP_1,
+                                                HKOS_SERIAL_PAR_NONE );
+
+    if ( error != HKOS_ERROR_NONE )
+        blink_error();
+
+    uint32_t last = hkos_get_switches();
+    hkos_tick_t last_wake = hkos_get_ticks();
+
+    while(1) {
+        hkos_sleep_until( &last_wake, 1000 );
+
+        uint32_t now = hkos_get_switches();
+        hkos_serial_print( 0, "switches/s: " );
+        print_number( now - last );
+        hkos_serial_print( 0, " group overlaps: " );
+        print_number( group_overlaps );
+        hkos_serial_println( 0, "" );
+
+        // the switches caused by the report itself are not counted
+        last = hkos_get_switches();
+    }
+}
+
+/**************************************************************************
+ * Helper function to add a task with priority and threshold
+ *
+ * @param[in]   p_task_func     task function
+ * @param[in]   stack_size      task stack size
+ * @param[in]   priority        task priority
+ * @param[in]   threshold       task preemption threshold
+ *
+ * ************************************************************************/
+static void add_task( void (*p_task_func)(),
+                      hkos_size_t stack_size,
+                      uint8_t priority,
+                      uint8_t threshold )
+{
+    void* p_task = hkos_add_task( p_task_func, stack_size );
+    if ( p_task == 0 )
+        blink_error();
+
+#if HKOS_SCHED_PRIORITY && BENCH_USE_THRESHOLD
+    hkos_set_priority( p_task, priority, threshold );
+#elif HKOS_SCHED_PRIORITY
+    hkos_set_priority( p_task, priority, priority );
+#endif
+}
+
+/**************************************************************************
+ * Example Entry point
+ *
+ * The filters form a non-preemptive group: the threshold of both is the
+ * highest priority in the group, so they never preempt each other, but
+ * the sensor can still preempt them.
+ *
+ * ************************************************************************/
+void setup( void ) {
+
+    hkos_gpio_write( 2, LOW );
+    hkos_gpio_write( 14, LOW );
+    hkos_gpio_config( 2, OUTPUT );
+    hkos_gpio_config( 14, OUTPUT );
+
+    add_task( filter_low,  32, PRIO_FILTER_LOW,  PRIO_FILTER_HIGH );
+    add_task( filter_high, 32, PRIO_FILTER_HIGH, PRIO_FILTER_HIGH );
+    add_task( sensor,      32, PRIO_SENSOR,      PRIO_SENSOR );
+    add_task( report,      64, PRIO_REPORT,      PRIO_REPORT );
+}
@@ -23,37 +23,24 @@
 
 
 /**************************************************************************
- * Helper function to blink a LED
+ * Task to blink a LED
  *
- * @param[in]   pin    pin number
+ * The same task function blinks the red LED (P1.0) and the green LED (P1.6)
+ * on Launchpad EXP430G2, each one in its own task.
+ *
+ * @param[in]   p_pin   pin number
  *
  * ************************************************************************/
-static void blink( uint8_t pin )
+static void blink( void* p_pin )
 {
+    uint8_t pin = (uint8_t)(uintptr_t)p_pin;
+
     while(1) {
         hkos_gpio_toggle( pin );
         hkos_sleep( 1000 );
     }
 }
 
-/**************************************************************************
- * Helper function to blink the green LED (P1.6) on Launchpad EXP430G2
- *
- * ************************************************************************/
-static void blink_green( void )
-{
-    blink( 14 );
-}
-
-/**************************************************************************
- * Helper function to blink the red LED (P1.0) on Launchpad EXP430G2
- *
- * ************************************************************************/
-static void blink_red( void )
-{
-    blink( 2 );
-}
-
 /**************************************************************************
  * Helper function to blink both LEDs em case of error
  *
@@ -82,10 +69,10 @@ void setup( void ) {
     hkos_gpio_config( 2, OUTPUT );
     hkos_gpio_config( 14, OUTPUT );
 
-    if ( hkos_add_task( blink_red, 16 ) == 0 )
+    if ( hkos_add_task_arg( blink, (void*)2, 16 ) == 0 )
         blink_error();
 
-    if ( hkos_add_task( blink_green, 16 ) == 0 )
+    if ( hkos_add_task_arg( blink, (void*)14, 16 ) == 0 )
         blink_error();
 
 }
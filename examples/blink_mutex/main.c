@@ -27,13 +27,18 @@
 void* g_mutex = NULL;
 
 /**************************************************************************
- * Helper function to blink a LED
+ * Task to blink a LED
  *
- * @param[in]   pin    pin number
+ * The same task function blinks the red LED (P1.0) and the green LED (P1.6)
+ * on Launchpad EXP430G2, each one in its own task.
+ *
+ * @param[in]   p_pin   pin number
  *
  * ************************************************************************/
-static void blink( uint8_t pin )
+static void blink( void* p_pin )
 {
+    uint8_t pin = (uint8_t)(uintptr_t)p_pin;
+
     while(1) {
         hkos_lock_mutex( g_mutex );
         hkos_gpio_write( pin, HIGH );
@@ -47,24 +52,6 @@ static void blink( uint8_t pin )
     }
 }
 
-/**************************************************************************
- * Helper function to blink the green LED (P1.6) on Launchpad EXP430G2
- *
- * ************************************************************************/
-static void blink_green( void )
-{
-    blink( 14 );
-}
-
-/**************************************************************************
- * Helper function to blink the red LED (P1.0) on Launchpad EXP430G2
- *
- * ************************************************************************/
-static void blink_red( void )
-{
-    blink( 2 );
-}
-
 /**************************************************************************
  * Helper function to blink both LEDs em case of error
  *
@@ -87,7 +74,6 @@ static void blink_error( void )
  * Example Entry point
  *
  * ************************************************************************/
-#include <msp430.h>
 void setup( void ) {
 
     hkos_gpio_write( 2, LOW );
@@ -102,10 +88,10 @@ void setup( void ) {
         blink_error();
 
 
-    if ( hkos_add_task( blink_red, 32 ) == NULL )
+    if ( hkos_add_task_arg( blink, (void*)2, 32 ) == NULL )
         blink_error();
 
-    if ( hkos_add_task( blink_green, 32 ) == NULL )
+    if ( hkos_add_task_arg( blink, (void*)14, 32 ) == NULL )
         blink_error();
 
 }
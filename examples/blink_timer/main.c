@@ -0,0 +1,85 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+#include <hkos.h>
+#include <stddef.h>
+
+
+/**************************************************************************
+ * Timer callback to toggle a LED
+ *
+ * @param[in]   p_pin   pin number
+ *
+ * ************************************************************************/
+static void toggle( void* p_pin )
+{
+    hkos_gpio_toggle( (uint8_t)(uintptr_t)p_pin );
+}
+
+/**************************************************************************
+ * Helper function to blink both LEDs em case of error
+ *
+ * ************************************************************************/
+static void blink_error( void )
+{
+    while( 1 ) {
+        hkos_gpio_toggle( 2 );
+        hkos_gpio_toggle( 14 );
+
+        volatile uint16_t i;
+        for ( i = 0; i < 65535; ++i );
+    }
+}
+
+/**************************************************************************
+ * Helper function to create and start a blinking timer
+ *
+ * @param[in]   pin         pin number
+ * @param[in]   period_ms   blinking period
+ *
+ * ************************************************************************/
+static void start_blinking( uint8_t pin, uint16_t period_ms )
+{
+    void* p_timer = hkos_timer_create( period_ms,
+                                       HKOS_TIMER_AUTO_RELOAD,
+                                       toggle,
+                                       (void*)(uintptr_t)pin );
+    if ( p_timer == NULL )
+        blink_error();
+
+    hkos_timer_start( p_timer );
+}
+
+/**************************************************************************
+ * Example Entry point
+ *
+ * ************************************************************************/
+void setup( void ) {
+
+    hkos_gpio_write( 2, LOW );
+    hkos_gpio_write( 14, LOW );
+    hkos_gpio_config( 2, OUTPUT );
+    hkos_gpio_config( 14, OUTPUT );
+
+    start_blinking( 2, 1000 );
+    start_blinking( 14, 500 );
+
+}
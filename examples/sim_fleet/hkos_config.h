@@ -0,0 +1,56 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+#ifndef __HKOS_CONFIG_H
+#define __HKOS_CONFIG_H
+
+// Configure HalfKOS time slice. A short one makes the idle nodes
+// wake up on time, so the sensors are spread over the period.
+#define HKOS_TIME_SLICE             1 // ms
+
+// Configure how many bytes are available in RAM for HKOS.
+//
+// This example only runs in the SIM port, but each node keeps the
+// budget of the MSP430G2553 to model the same system.
+//
+// 512 - 4 ( TI's heap ) - serial buffers - serial wait lists = 470
+#define HKOS_AVAILABLE_RAM          470 // bytes
+
+
+// Configure how many bytes are available for
+// HalfKOS idle stack, used for HalfKOS housekeeping
+// Except in case you are doing something really
+// exotic, 32 bytes for HalfKOS idle stack should be
+// sufficient.
+//
+#define HKOS_IDLE_STACK             32 // bytes
+
+
+// Configure 2 serial ports: the console and the bus. The gateway
+// needs room for the messages arriving together.
+#define HKOS_SERIAL_PORTS_ENABLE    2
+#define HKOS_SERIAL_BUFFER_SIZE     64
+
+// Each node is an instance of HalfKOS
+#define HKOS_MULTI_INSTANCE         1
+
+#endif // __HKOS_CONFIG_H
@@ -0,0 +1,250 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+#include <hkos.h>
+#include <hkos_sim.h>
+
+// Number of sensor nodes
+#ifndef SENSORS
+#define SENSORS         200
+#endif
+
+// Every sensor sends a reading each period
+#define PERIOD_MS       100
+
+// Serial port 0 is the console of the gateway and the nodes talk through
+// serial port 1, connected to a bus
+#define CONSOLE         0
+#define BUS             1
+#define BUS_LINE        0
+
+// State of each sensor node
+static HKOS_INSTANCE_LOCAL uint16_t sequence;
+
+// State of the gateway, only used by instance 0
+static uint16_t expected[ SENSORS + 1 ];    // next sequence, by instance
+static uint32_t messages;
+static uint32_t lost;
+static uint32_t value_sum;
+
+/**************************************************************************
+ * Helper function to format an unsigned number
+ *
+ * @param[out]  p_end   end of the buffer receiving the number
+ * @param[in]   value   number to be formatted
+ *
+ * @return  The beginning of the number
+ *
+ * ************************************************************************/
+static char* format_number( char* p_end, uint32_t value )
+{
+    do {
+        *--p_end = '0' + ( value % 10 );
+        value /= 10;
+    } while ( value > 0 );
+
+    return p_end;
+}
+
+/**************************************************************************
+ * Helper function to print an unsigned number
+ *
+ * @param[in]   value   number to be printed
+ *
+ * ************************************************************************/
+static void print_number( uint32_t value )
+{
+    char buffer[11];
+
+    buffer[ sizeof(buffer) - 1 ] = '\0';
+    hkos_serial_print( CONSOLE,
+                       format_number( &buffer[ sizeof(buffer) - 1 ], value ) );
+}
+
+/**************************************************************************
+ * Helper function to open a serial port
+ *
+ * @param[in]   port    port number
+ *
+ * ************************************************************************/
+static void open_port( uint8_t port )
+{
+    hkos_serial_open( port,
+                      9600,
+                      HKOS_SERIAL_DATA_8,
+                      HKOS_SERIAL_STOP_1,
+                      HKOS_SERIAL_PAR_NONE );
+}
+
+/**************************************************************************
+ * Sensor task
+ *
+ * Sends "<instance> <sequence> <value>" through the bus every period. The
+ * sensors are spread over the period, so they do not talk all at once.
+ *
+ * ************************************************************************/
+static void sensor( void )
+{
+    unsigned id = hkos_sim_instance();
+
+    open_port( BUS );
+    hkos_sleep( 1 + id % PERIOD_MS );
+
+    hkos_tick_t last_wake = hkos_get_ticks();
+    while(1) {
+        // models reading and filtering the sensor
+        hkos_sim_consume( 50000 );
+        uint32_t value = ( id * 37 + sequence * 11 ) % 1000;
+
+        char message[24];
+        char* p = &message[ sizeof(message) ];
+        *--p = '\n';
+        p = format_number( p, value );
+        *--p = ' ';
+        p = format_number( p, sequence );
+        *--p = ' ';
+        p = format_number( p, id );
+
+        hkos_serial_write_buffer( BUS, p, &message[ sizeof(message) ] - p );
+        ++sequence;
+
+        hkos_sleep_until( &last_wake, PERIOD_MS );
+    }
+}
+
+/**************************************************************************
+ * Helper function to handle a message received by the gateway
+ *
+ * @param[in]   p_message   the message, without the end of line
+ *
+ * ************************************************************************/
+static void handle_message( const char* p_message )
+{
+    uint32_t fields[3] = { 0, 0, 0 };
+    uint8_t field = 0;
+
+    for (; *p_message != '\0'; ++p_message ) {
+        if ( *p_message == ' ' ) {
+            if ( ++field == 3 )
+                return;
+        } else if ( *p_message >= '0' && *p_message <= '9' ) {
+            fields[field] = fields[field] * 10 + ( *p_message - '0' );
+        } else {
+            return;
+        }
+    }
+
+    if ( field != 2 || fields[0] == 0 || fields[0] > SENSORS )
+        return;
+
+    // the gaps in the sequence are messages lost in the rx buffer
+    lost += (uint16_t)( fields[1] - expected[ fields[0] ] );
+    expected[ fields[0] ] = fields[1] + 1;
+
+    value_sum += fields[2];
+    ++messages;
+}
+
+/**************************************************************************
+ * Gateway task
+ *
+ * Receives the messages of the sensors
+ *
+ * ************************************************************************/
+static void gateway( void )
+{
+    char message[24];
+    uint8_t size = 0;
+
+    open_port( BUS );
+
+    while(1) {
+        hkos_serial_wait( BUS );
+
+        int16_t c;
+        while ( ( c = hkos_serial_read( BUS ) ) >= 0 ) {
+            if ( c == '\n' ) {
+                message[size] = '\0';
+                handle_message( message );
+                size = 0;
+            } else if ( size < sizeof(message) - 1 ) {
+                message[size++] = c;
+            }
+        }
+    }
+}
+
+/**************************************************************************
+ * Report task
+ *
+ * Prints the statistics of the gateway every second.
+ *
+ * ************************************************************************/
+static void report( void )
+{
+    open_port( CONSOLE );
+
+    hkos_tick_t last_wake = hkos_get_ticks();
+    while(1) {
+        hkos_sleep_until( &last_wake, 1000 );
+
+        hkos_serial_print( CONSOLE, "messages: " );
+        print_number( messages );
+        hkos_serial_print( CONSOLE, " lost: " );
+        print_number( lost );
+        hkos_serial_print( CONSOLE, " average value: " );
+        print_number( messages ? value_sum / messages : 0 );
+        hkos_serial_println( CONSOLE, "" );
+
+        messages = 0;
+        lost = 0;
+        value_sum = 0;
+    }
+}
+
+/**************************************************************************
+ * Entry point of the sensor nodes
+ *
+ * ************************************************************************/
+static void sensor_setup( void ) {
+
+    hkos_add_task( sensor, 64 );
+}
+
+/**************************************************************************
+ * Example Entry point
+ *
+ * Runs on the gateway, which is instance 0, and adds the sensor nodes.
+ *
+ * ************************************************************************/
+void setup( void ) {
+
+    hkos_sim_connect( 0, BUS, BUS_LINE );
+
+    for ( unsigned i = 0; i < SENSORS; ++i ) {
+        int id = hkos_sim_add_instance( sensor_setup );
+        if ( id >= 0 )
+            hkos_sim_connect( id, BUS, BUS_LINE );
+    }
+
+    hkos_add_task( gateway, 64 );
+    hkos_add_task( report, 64 );
+}
@@ -0,0 +1,138 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+#include <hkos.h>
+#include <hkos_sim.h>
+
+// Work queue running the jobs released by the interrupts
+static hkos_workqueue_t* p_wq;
+static hkos_work_t work;
+
+// Response time statistics
+static uint64_t release;        // ns
+static uint64_t worst;          // ns
+static uint32_t jobs;
+static uint32_t lost;
+
+/**************************************************************************
+ * Helper function to print an unsigned number
+ *
+ * @param[in]   value   number to be printed
+ *
+ * ************************************************************************/
+static void print_number( uint32_t value )
+{
+    char buffer[11];
+    char* p = &buffer[ sizeof(buffer) - 1 ];
+
+    *p = '\0';
+    do {
+        *--p = '0' + ( value % 10 );
+        value /= 10;
+    } while ( value > 0 );
+
+    hkos_serial_print( 0, p );
+}
+
+/**************************************************************************
+ * Job released by the interrupt
+ *
+ * Its response time goes from the interrupt to its end.
+ *
+ * @param[in]   p_cost  modelled execution time in us
+ *
+ * ************************************************************************/
+static void job( void* p_cost )
+{
+    hkos_sim_consume( (uint32_t)(uintptr_t)p_cost * 1000 );
+
+    uint64_t response = hkos_sim_time() - release;
+    if ( response > worst )
+        worst = response;
+    ++jobs;
+}
+
+/**************************************************************************
+ * Interrupt service routine of the irq events of the script
+ *
+ * @param[in]   irq     interrupt number
+ * @param[in]   arg     execution time of the job in us
+ *
+ * ************************************************************************/
+void hkos_sim_irq_hook( uint8_t irq, uint32_t arg )
+{
+    if ( hkos_work_submit( p_wq, &work, job, (void*)(uintptr_t)arg ) ) {
+        release = hkos_sim_time();
+    } else {
+        ++lost;
+    }
+}
+
+/**************************************************************************
+ * Background task
+ *
+ * Keeps the CPU busy, so the jobs wait for the end of its time slice.
+ *
+ * ************************************************************************/
+static void background( void )
+{
+    while(1) {
+        hkos_sim_consume( 100000 );
+    }
+}
+
+/**************************************************************************
+ * Report task
+ *
+ * Prints the statistics every second.
+ *
+ * ************************************************************************/
+static void report( void )
+{
+    hkos_serial_open( 0,
+                      9600,
+                      HKOS_SERIAL_DATA_8,
+                      HKOS_SERIAL_STOP_1,
+                      HKOS_SERIAL_PAR_NONE );
+
+    while(1) {
+        hkos_sleep( 1000 );
+
+        hkos_serial_print( 0, "jobs: " );
+        print_number( jobs );
+        hkos_serial_print( 0, " lost: " );
+        print_number( lost );
+        hkos_serial_print( 0, " worst response: " );
+        print_number( (uint32_t)( worst / 1000 ) );
+        hkos_serial_println( 0, " us" );
+    }
+}
+
+/**************************************************************************
+ * Example Entry point
+ *
+ * ************************************************************************/
+void setup( void ) {
+
+    p_wq = hkos_workqueue_create( 64 );
+    hkos_add_task( background, 32 );
+    hkos_add_task( report, 64 );
+}
@@ -25,6 +25,7 @@
  * Glue logic between the HalfKOS interface and core functions
  *
  * ************************************************************************/
+#include <stddef.h>
 #include <hkos.h>
 #include <hkos_hal.h>
 #include <hkos_scheduler.h>
@@ -47,7 +48,22 @@ extern void setup( void );
  *****************************************************************************/
 void hkos_init( void ) {
     hkos_hal_init();
+#if HKOS_TRACE
+    hkos_trace_init();
+#endif
+#if HKOS_PROFILER
+    hkos_profiler_init();
+#endif
+#if HKOS_PROF_REGIONS > 0
+    hkos_prof_init();
+#endif
     hkos_scheduler_init();
+#if HKOS_TIMERS_ENABLE > 0
+    hkos_timer_init();
+#endif
+#if HKOS_HANDLERS_ENABLE > 0
+    hkos_handler_init();
+#endif
 }
 
 /******************************************************************************
@@ -69,11 +85,273 @@ void hkos_start( void ) {
  *****************************************************************************/
 void* hkos_add_task( void (*p_task_func)(), hkos_size_t stack_size ) {
     hkos_hal_enter_critical_section();
-    void* ret = hkos_scheduler_add_task( p_task_func, stack_size );
+    void* ret = hkos_scheduler_add_task( p_task_func, NULL, stack_size );
     hkos_hal_exit_critical_section();
     return ret;
 }
 
+/******************************************************************************
+ * Add a task that receives an argument to HalfKOS scheduler
+ *
+ * @param[in]   p_task_func     Pointer to the task address
+ * @param[in]   p_arg           Argument passed to the task function
+ * @param[in]   stack_size      Size of the task's size
+ *
+ * @return  Pointer to the task structure or NULL if task cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_add_task_arg( void (*p_task_func)( void* ),
+                         void* p_arg,
+                         hkos_size_t stack_size )
+{
+    hkos_hal_enter_critical_section();
+    void* ret = hkos_scheduler_add_task( p_task_func, p_arg, stack_size );
+    hkos_hal_exit_critical_section();
+    return ret;
+}
+
+/******************************************************************************
+ * Add a periodic task to HalfKOS scheduler
+ *
+ * @param[in]   p_job           Function executed once per period
+ * @param[in]   period_ms       Period of the task in milliseconds
+ * @param[in]   stack_size      Size of the task's size
+ *
+ * @return  Pointer to the task structure or NULL if task cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_add_periodic_task( void (*p_job)(),
+                              uint32_t period_ms,
+                              hkos_size_t stack_size )
+{
+    hkos_hal_enter_critical_section();
+    void* ret = hkos_scheduler_add_periodic_task( p_job,
+                                                  HKOS_MS_TO_TICKS( period_ms ),
+                                                  stack_size );
+    hkos_hal_exit_critical_section();
+    return ret;
+}
+
+/******************************************************************************
+ * Get the number of overruns of a periodic task
+ *
+ * @param[in]   p_task          Pointer to the task structure returned by
+ *                              hkos_add_periodic_task
+ *
+ * @return  Number of jobs that were still running at their next release
+ *
+ *****************************************************************************/
+uint16_t hkos_get_overruns( void* p_task ) {
+    hkos_hal_enter_critical_section();
+    uint16_t overruns = ((hkos_periodic_task_t*)p_task)->overruns;
+    hkos_hal_exit_critical_section();
+    return overruns;
+}
+
+#if HKOS_SCHED_EDF
+/******************************************************************************
+ * Set the relative deadline of a periodic task
+ *
+ * @param[in]   p_task          Pointer to the task structure returned by
+ *                              hkos_add_periodic_task
+ * @param[in]   deadline_ms     Deadline relative to each release in
+ *                              milliseconds
+ *
+ *****************************************************************************/
+void hkos_set_deadline( void* p_task, uint32_t deadline_ms ) {
+    hkos_hal_enter_critical_section();
+    hkos_scheduler_set_deadline( p_task, HKOS_MS_TO_TICKS( deadline_ms ) );
+    hkos_hal_exit_critical_section();
+}
+
+/******************************************************************************
+ * Get the number of deadline misses of a periodic task
+ *
+ * @param[in]   p_task          Pointer to the task structure returned by
+ *                              hkos_add_periodic_task
+ *
+ * @return  Number of jobs that finished after their absolute deadline
+ *
+ *****************************************************************************/
+uint16_t hkos_get_deadline_misses( void* p_task ) {
+    hkos_hal_enter_critical_section();
+    uint16_t misses = ((hkos_periodic_task_t*)p_task)->deadline_misses;
+    hkos_hal_exit_critical_section();
+    return misses;
+}
+#endif
+
+#if HKOS_PER_TASK_TIME_SLICE
+/******************************************************************************
+ * Set the time slice of a task
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ * @param[in]   time_slice_ms   Time slice in milliseconds. 0 makes the task
+ *                              run until it blocks
+ *
+ *****************************************************************************/
+void hkos_set_time_slice( void* p_task, uint16_t time_slice_ms ) {
+    hkos_hal_enter_critical_section();
+    hkos_scheduler_set_time_slice( p_task,
+                                   (uint16_t)HKOS_MS_TO_TICKS( time_slice_ms ) );
+    hkos_hal_exit_critical_section();
+}
+
+/******************************************************************************
+ * Get the number of times a task was preempted
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ *
+ * @return  Number of times the task lost the CPU without blocking
+ *
+ *****************************************************************************/
+uint16_t hkos_get_preemptions( void* p_task ) {
+    hkos_hal_enter_critical_section();
+    uint16_t preemptions = ((hkos_task_t*)p_task)->preemptions;
+    hkos_hal_exit_critical_section();
+    return preemptions;
+}
+#endif
+
+#if HKOS_SCHED_PRIORITY
+/******************************************************************************
+ * Set the priority and the preemption threshold of a task
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ * @param[in]   priority        Priority of the task. Higher runs first
+ * @param[in]   threshold       Preemption threshold
+ *
+ *****************************************************************************/
+void hkos_set_priority( void* p_task, uint8_t priority, uint8_t threshold ) {
+    hkos_hal_enter_critical_section();
+    hkos_scheduler_set_priority( p_task, priority, threshold );
+    hkos_hal_exit_critical_section();
+}
+#endif
+
+#if HKOS_SWITCH_COUNTER
+/******************************************************************************
+ * Get the number of context switches since HalfKOS started
+ *
+ * @return  The number of times the running task (or idle) changed
+ *
+ *****************************************************************************/
+uint32_t hkos_get_switches( void ) {
+    hkos_hal_enter_critical_section();
+    uint32_t switches = hkos_scheduler_get_switches();
+    hkos_hal_exit_critical_section();
+    return switches;
+}
+#endif
+
+#if HKOS_PAINT_TASK_STACK
+/******************************************************************************
+ * Get the number of bytes of a task stack that were never used
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ *
+ * @return  Number of bytes never used
+ *
+ *****************************************************************************/
+hkos_size_t hkos_get_stack_unused( void* p_task ) {
+    hkos_hal_enter_critical_section();
+    hkos_size_t unused = hkos_scheduler_get_stack_unused( p_task );
+    hkos_hal_exit_critical_section();
+    return unused;
+}
+
+/******************************************************************************
+ * Get the number of bytes of the os stack that were never used
+ *
+ * @return  Number of bytes never used
+ *
+ *****************************************************************************/
+hkos_size_t hkos_get_os_stack_unused( void ) {
+    hkos_hal_enter_critical_section();
+    hkos_size_t unused = hkos_scheduler_get_os_stack_unused();
+    hkos_hal_exit_critical_section();
+    return unused;
+}
+#endif
+
+#if HKOS_TASK_STATS
+/******************************************************************************
+ * Get the statistics of a task
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ * @param[out]  p_stats         The statistics of the task
+ *
+ *****************************************************************************/
+void hkos_get_task_stats( void* p_task, hkos_task_stats_t* p_stats ) {
+    hkos_hal_enter_critical_section();
+    hkos_scheduler_get_task_stats( p_task, p_stats );
+    hkos_hal_exit_critical_section();
+}
+
+/******************************************************************************
+ * Get the time the CPU was idle since HalfKOS started
+ *
+ * @param[out]  p_idle          The idle time
+ *
+ *****************************************************************************/
+void hkos_get_idle_time( hkos_run_time_t* p_idle ) {
+    hkos_hal_enter_critical_section();
+    hkos_scheduler_get_idle_time( p_idle );
+    hkos_hal_exit_critical_section();
+}
+
+/******************************************************************************
+ * Get the CPU load since the previous call
+ *
+ * @return  Percentage of the time the CPU was not idle
+ *
+ *****************************************************************************/
+uint8_t hkos_get_cpu_load( void ) {
+    hkos_hal_enter_critical_section();
+    uint8_t load = hkos_scheduler_get_cpu_load();
+    hkos_hal_exit_critical_section();
+    return load;
+}
+#endif
+
+#if HKOS_IRQ_STATS
+/******************************************************************************
+ * Get the interrupt statistics
+ *
+ * @param[out]  p_stats         The interrupt statistics
+ *
+ *****************************************************************************/
+void hkos_get_irq_stats( hkos_irq_stats_t* p_stats ) {
+    hkos_hal_get_irq_stats( p_stats );
+}
+
+/******************************************************************************
+ * Discard the interrupt statistics
+ *
+ *****************************************************************************/
+void hkos_reset_irq_stats( void ) {
+    hkos_hal_reset_irq_stats();
+}
+#endif
+
+#if HKOS_TASK_RESTART
+/******************************************************************************
+ * Restart a task
+ *
+ * @param[in]   p_task          Pointer to the task structure returned by
+ *                              hkos_add_task
+ *
+ * @return  false if the task cannot be restarted
+ *
+ *****************************************************************************/
+bool hkos_restart_task( void* p_task ) {
+    hkos_hal_enter_critical_section();
+    bool ret = hkos_scheduler_restart_task( p_task );
+    hkos_hal_exit_critical_section();
+    return ret;
+}
+#endif
+
 /******************************************************************************
  * Remove a task from HalfKOS scheduler
  *
@@ -145,10 +423,66 @@ void hkos_destroy_mutex( void* p_mutex ) {
  * @param[in]       time_ms     The time to suspend the task in milliseconds
  *
  * ***************************************************************************/
-void hkos_sleep( uint16_t time_ms ) {
+void hkos_sleep( uint32_t time_ms ) {
+    hkos_hal_enter_critical_section();
+    hkos_scheduler_sleep( HKOS_MS_TO_TICKS( time_ms ) );
+    hkos_hal_exit_critical_section();
+}
+
+/******************************************************************************
+ * Suspend the callee until its next periodic release
+ *
+ * @param[inout]    p_last_wake     The previous release time in ticks
+ * @param[in]       period_ms       The period in milliseconds
+ *
+ * @return  false if the release time had already been reached
+ *
+ * ***************************************************************************/
+bool hkos_sleep_until( hkos_tick_t* p_last_wake, uint32_t period_ms ) {
+    hkos_hal_enter_critical_section();
+    bool slept = hkos_scheduler_sleep_until( p_last_wake,
+                                             HKOS_MS_TO_TICKS( period_ms ) );
+    hkos_hal_exit_critical_section();
+    return slept;
+}
+
+/******************************************************************************
+ * Get the number of ticks since HalfKOS started
+ *
+ * @return  The tick counter
+ *
+ * ***************************************************************************/
+hkos_tick_t hkos_get_ticks( void ) {
+    // the counter is wider than the CPU word, so it is read atomically
+    hkos_hal_enter_critical_section();
+    hkos_tick_t ticks = hkos_scheduler_get_ticks();
+    hkos_hal_exit_critical_section();
+
+    return ticks;
+}
+
+/******************************************************************************
+ * Get the time since HalfKOS started
+ *
+ * @return  The uptime in milliseconds
+ *
+ * ***************************************************************************/
+hkos_tick_t hkos_uptime_ms( void ) {
+    return HKOS_TICKS_TO_MS( hkos_get_ticks() );
+}
+
+/******************************************************************************
+ * Yield the execution to another ready task
+ *
+ * ***************************************************************************/
+void hkos_yield( void ) {
+#if HKOS_SCHED_PRIORITY
+    // the running task keeps its place unless it yields
     hkos_hal_enter_critical_section();
-    hkos_scheduler_sleep( time_ms );
+    hkos_scheduler_rotate();
     hkos_hal_exit_critical_section();
+#endif
+    hkos_scheduler_yield();
 }
 
 /******************************************************************************
@@ -22,10 +22,164 @@
 #ifndef __HKOS_CORE_H
 #define __HKOS_CORE_H
 
+#include <stdbool.h>
 #include <hkos_arch_hal.h>
+#include <hkos_config.h>
 
 #define HKOS_TIMEOUT_INFINITE               0xFFFF
 
+// If HKOS_TICK_64BIT is not defined in hkos_config.h, define it as 0
+#ifndef HKOS_TICK_64BIT
+#define HKOS_TICK_64BIT                     0
+#endif
+
+// Scheduling policy
+//
+// By default, the ready tasks run in round-robin. If HKOS_SCHED_EDF is set
+// in hkos_config.h, the periodic task with the earliest absolute deadline
+// runs first and the other tasks run in round-robin when no periodic task
+// is ready.
+#ifndef HKOS_SCHED_EDF
+#define HKOS_SCHED_EDF                      0
+#endif
+
+// If HKOS_SCHED_PRIORITY is set in hkos_config.h, the ready task with the
+// highest priority runs first, using the preemption threshold model: once
+// a task is dispatched, it runs at its preemption threshold, so only tasks
+// with a priority above the threshold can preempt it. Tasks with the same
+// priority run in round-robin, but a task with a threshold above its
+// priority is not time sliced, so it keeps the CPU until it blocks or yields.
+#ifndef HKOS_SCHED_PRIORITY
+#define HKOS_SCHED_PRIORITY                 0
+#endif
+
+#if HKOS_SCHED_EDF && HKOS_SCHED_PRIORITY
+#error "HKOS_SCHED_EDF and HKOS_SCHED_PRIORITY cannot be used together"
+#endif
+
+// Default priority of the tasks when HKOS_SCHED_PRIORITY is set
+#ifndef HKOS_DEFAULT_PRIORITY
+#define HKOS_DEFAULT_PRIORITY               1
+#endif
+
+// If HKOS_SWITCH_COUNTER is set in hkos_config.h, the scheduler counts the
+// context switches. Useful to compare scheduling configurations.
+#ifndef HKOS_SWITCH_COUNTER
+#define HKOS_SWITCH_COUNTER                 0
+#endif
+
+// If HKOS_PER_TASK_TIME_SLICE is set in hkos_config.h, each task has its
+// own time slice, which starts as HKOS_TIME_SLICE, and counts how many
+// times it was preempted.
+#ifndef HKOS_PER_TASK_TIME_SLICE
+#define HKOS_PER_TASK_TIME_SLICE            0
+#endif
+
+// If HKOS_TASK_RESTART is set in hkos_config.h, each task keeps its entry
+// point and stack size, so it can be restarted in its own memory block.
+#ifndef HKOS_TASK_RESTART
+#define HKOS_TASK_RESTART                   0
+#endif
+
+// If HKOS_PAINT_TASK_STACK is set in hkos_config.h, the stacks are filled
+// with HKOS_STACK_PAINT_VALUE when created, so the unused part of each stack
+// can be measured.
+#ifndef HKOS_PAINT_TASK_STACK
+#define HKOS_PAINT_TASK_STACK               0
+#endif
+
+#ifndef HKOS_STACK_PAINT_VALUE
+#define HKOS_STACK_PAINT_VALUE              0xFF
+#endif
+
+// If HKOS_STACK_CHECK is set in hkos_config.h, a canary word is kept below
+// each task stack. The stack pointer and the canary of the task leaving the
+// CPU are checked at every context switch and hkos_stack_overflow_hook is
+// called if the task overflowed its stack.
+#ifndef HKOS_STACK_CHECK
+#define HKOS_STACK_CHECK                    0
+#endif
+
+// If HKOS_TASK_STATS is set in hkos_config.h, the scheduler measures the
+// CPU time of each task and of idle, and counts how each task left the CPU.
+// The HAL must implement hkos_hal_get_tick_fraction.
+#ifndef HKOS_TASK_STATS
+#define HKOS_TASK_STATS                     0
+#endif
+
+// If HKOS_PREEMPTION is set to 0 in hkos_config.h, the tick only keeps the
+// time and wakes up the sleeping tasks. Tasks switch only when they block
+// or call hkos_yield, so a task is never interrupted by another one.
+#ifndef HKOS_PREEMPTION
+#define HKOS_PREEMPTION                     1
+#endif
+
+// Number of code regions measured by hkos_prof_begin and hkos_prof_end.
+// 0 disables them. The HAL must implement hkos_hal_get_cycles.
+#ifndef HKOS_PROF_REGIONS
+#define HKOS_PROF_REGIONS                   0
+#endif
+
+// If HKOS_PROF_EXCLUDE_OTHERS is set in hkos_config.h, the time other tasks
+// run while a task is inside a region is not counted in the region.
+#ifndef HKOS_PROF_EXCLUDE_OTHERS
+#define HKOS_PROF_EXCLUDE_OTHERS            0
+#endif
+
+// If HKOS_IRQ_STATS is set in hkos_config.h, the HAL measures the longest
+// time the kernel keeps the interrupts disabled and the interrupt latency.
+// The HAL must implement hkos_hal_get_irq_stats and hkos_hal_reset_irq_stats.
+#ifndef HKOS_IRQ_STATS
+#define HKOS_IRQ_STATS                      0
+#endif
+
+/******************************************************************************
+ * Tick data types
+ *
+ * hkos_tick_t is used to store the number of ticks since HalfKOS started.
+ * It wraps around, so ticks must be compared using hkos_tick_reached.
+ * A 32 bit counter wraps after 49 days at 1000 ticks per second. Set
+ * HKOS_TICK_64BIT in hkos_config.h if that is not enough.
+ *
+ *****************************************************************************/
+#if HKOS_TICK_64BIT
+typedef uint64_t                            hkos_tick_t;
+typedef int64_t                             hkos_tick_diff_t;
+#else
+typedef uint32_t                            hkos_tick_t;
+typedef int32_t                             hkos_tick_diff_t;
+#endif
+
+// Wrap safe check if the tick counter (now) has reached a given tick
+#define hkos_tick_reached( now, tick )      \
+            ( (hkos_tick_diff_t)( (hkos_tick_t)( now ) - (hkos_tick_t)( tick ) ) >= 0 )
+
+/******************************************************************************
+ * Conversion between milliseconds and ticks
+ *
+ * The conversion is chosen at compile time from HKOS_HAL_TICKS_IN_A_SECOND,
+ * so the common tick rates need no division at runtime. Milliseconds are
+ * rounded up to the next tick, so a sleep is never shorter than requested.
+ *
+ *****************************************************************************/
+#if ( HKOS_HAL_TICKS_IN_A_SECOND % 1000 ) == 0
+#define HKOS_MS_TO_TICKS( ms )              ( (hkos_tick_t)( ms ) \
+                                                * ( HKOS_HAL_TICKS_IN_A_SECOND / 1000 ) )
+#define HKOS_TICKS_TO_MS( ticks )           ( (hkos_tick_t)( ticks ) \
+                                                / ( HKOS_HAL_TICKS_IN_A_SECOND / 1000 ) )
+#elif ( 1000 % HKOS_HAL_TICKS_IN_A_SECOND ) == 0
+#define HKOS_MS_TO_TICKS( ms )              ( ( (hkos_tick_t)( ms ) \
+                                                + ( 1000 / HKOS_HAL_TICKS_IN_A_SECOND ) - 1 ) \
+                                                / ( 1000 / HKOS_HAL_TICKS_IN_A_SECOND ) )
+#define HKOS_TICKS_TO_MS( ticks )           ( (hkos_tick_t)( ticks ) \
+                                                * ( 1000 / HKOS_HAL_TICKS_IN_A_SECOND ) )
+#else
+#define HKOS_MS_TO_TICKS( ms )              ( (hkos_tick_t)( ( (uint64_t)( ms ) \
+                                                * HKOS_HAL_TICKS_IN_A_SECOND + 999 ) / 1000 ) )
+#define HKOS_TICKS_TO_MS( ticks )           ( (hkos_tick_t)( (uint64_t)( ticks ) \
+                                                * 1000 / HKOS_HAL_TICKS_IN_A_SECOND ) )
+#endif
+
 /******************************************************************************
  * Size data type is the same as the dynamic header size data type
  *
@@ -35,4 +189,92 @@
  *****************************************************************************/
 typedef hkos_dmem_header_t  hkos_size_t;
 
+// Ports with wider pointers than the MCUs HalfKOS was written for need more
+// bytes for the same tasks, so hkos_arch_hal.h may scale HKOS_AVAILABLE_RAM
+#ifndef HKOS_HAL_RAM_SCALE
+#define HKOS_HAL_RAM_SCALE                  1
+#endif
+
+// If HKOS_MULTI_INSTANCE is set in hkos_config.h, the kernel state is local
+// to the host thread running HalfKOS, so a port can run many instances of
+// HalfKOS in one process, each on its own thread. Only ports that define
+// HKOS_HAL_HAS_INSTANCES in hkos_arch_hal.h support it.
+#ifndef HKOS_MULTI_INSTANCE
+#define HKOS_MULTI_INSTANCE                 0
+#endif
+
+#ifndef HKOS_HAL_HAS_INSTANCES
+#define HKOS_HAL_HAS_INSTANCES              0
+#endif
+
+// Storage class of the kernel state. Application state that must not be
+// shared by the instances may use it too.
+#if HKOS_MULTI_INSTANCE
+#if !HKOS_HAL_HAS_INSTANCES
+#error "HKOS_MULTI_INSTANCE is not supported by this port"
+#endif
+#define HKOS_INSTANCE_LOCAL                 __thread
+#else
+#define HKOS_INSTANCE_LOCAL
+#endif
+
+#if HKOS_TASK_STATS
+/******************************************************************************
+ * CPU time
+ *
+ * The time is kept in ticks plus a fraction of a tick, so it has the range
+ * of the tick counter and the resolution of the HAL timer. The fraction is
+ * in 1/HKOS_HAL_TICK_FRACTIONS of a tick.
+ *
+ *****************************************************************************/
+typedef struct hkos_run_time_t {
+    hkos_tick_t             ticks;
+    uint16_t                fraction;
+} hkos_run_time_t;
+
+/******************************************************************************
+ * Task statistics
+ *
+ * A task leaves the CPU voluntarily when it blocks or yields and is
+ * preempted when the tick timer gives the CPU to another task.
+ *
+ *****************************************************************************/
+typedef struct hkos_task_stats_t {
+    hkos_run_time_t         run_time;
+    uint16_t                voluntary_switches;
+    uint16_t                preemptions;
+} hkos_task_stats_t;
+#endif
+
+#if HKOS_IRQ_STATS
+/******************************************************************************
+ * Interrupt statistics
+ *
+ * The times are in cycles of hkos_hal_get_cycles. A serial port does not
+ * overrun while max_disabled + max_latency is below the time of one
+ * character, e.g. 10 bits / 115200 baud.
+ *
+ *****************************************************************************/
+typedef struct hkos_irq_stats_t {
+    uint32_t                max_disabled;       // longest critical section
+    uintptr_t               max_disabled_site;  // code that entered it
+    uint32_t                max_latency;        // longest interrupt latency
+    uint32_t                latency_samples;
+} hkos_irq_stats_t;
+#endif
+
+#if HKOS_STACK_CHECK
+/******************************************************************************
+ * Called when a task overflows its stack
+ *
+ * It is called from the context switch, with interrupts disabled, right
+ * after the task left the CPU. The default implementation hangs, so the
+ * application can define its own hook to log the task and reset the device.
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ *
+ *****************************************************************************/
+void hkos_stack_overflow_hook( void* p_task );
+#endif
+
 #endif //__HKOS_CORE_H
\ No newline at end of file
@@ -30,6 +30,12 @@
  *                          unimplemented if user code does not call them.
  *
  *      - All APIs in the peripherals folder
+ *      - hkos_hal_get_tick_fraction, only called when HKOS_TASK_STATS or
+ *        HKOS_TRACE is set
+ *      - hkos_hal_get_saved_pc, only called when HKOS_PROFILER is set
+ *      - hkos_hal_get_cycles, only called when HKOS_PROF_REGIONS is set
+ *      - hkos_hal_get_irq_stats and hkos_hal_reset_irq_stats, only called
+ *        when HKOS_IRQ_STATS is set
  *
  * 2. MANDATORY functions: they are called by HalfKOS core functtions and
  *                          must be implemented otherwise a compilation time
@@ -41,6 +47,8 @@
  *      - hkos_hal_jump_to_os
  *      - hkos_hal_enter_critical_section
  *      - hkos_hal_exit_critical_section
+ *      - hkos_hal_save_context and hkos_hal_restore_context or, when the
+ *        HAL defines HKOS_HAL_HAS_YIELD, hkos_hal_yield
  *
  * 3. FUNCTIONS TO BE CALLED :
  *
@@ -83,12 +91,15 @@ void hkos_hal_init( void );
  * @param[in]   p_sp        a pointer to the stack pointer indicating the
  *                          memory region of the task stack
  * @param[in]   p_pc        a pointer to the beginning of the task code
+ * @param[in]   p_arg       the argument the task code receives as its first
+ *                          parameter
  * @param[in]   stack_size  the size of the task's stack
  *
  * @return  The value of stack pointer after the stack initialization
  *
  *****************************************************************************/
-void* hkos_hal_init_stack( void* p_sp, void* p_pc, hkos_size_t stack_size );
+void* hkos_hal_init_stack( void* p_sp, void* p_pc, void* p_arg,
+                           hkos_size_t stack_size );
 
 
 /******************************************************************************
@@ -102,6 +113,25 @@ void* hkos_hal_init_stack( void* p_sp, void* p_pc, hkos_size_t stack_size );
 hkos_size_t hkos_hal_get_min_stack_size( void );
 
 
+// Set to 1 in hkos_arch_hal.h when the HAL switches contexts with
+// hkos_hal_yield instead of the naked save and restore functions
+#ifndef HKOS_HAL_HAS_YIELD
+#define HKOS_HAL_HAS_YIELD      0
+#endif
+
+#if HKOS_HAL_HAS_YIELD
+/******************************************************************************
+ * Yield the CPU to the next task
+ *
+ * For HALs that cannot write naked functions, e.g. hosted ones. It must save
+ * the context of the running task, call hkos_scheduler_switch_context and
+ * resume the new running task (hkos_ram.runtime_data.p_running_task) or the
+ * idle loop if it is NULL. Returns when the calling task runs again.
+ *
+ *****************************************************************************/
+void hkos_hal_yield( void );
+
+#else
 /******************************************************************************
  * Save context for a context switch
  *
@@ -128,6 +158,7 @@ void hkos_hal_save_context( void ) __attribute__((naked));
  *
  *****************************************************************************/
 void hkos_hal_restore_context( void ) __attribute__((naked));
+#endif // HKOS_HAL_HAS_YIELD
 
 
 /******************************************************************************
@@ -174,4 +205,96 @@ void hkos_hal_enter_critical_section( void );
 void hkos_hal_exit_critical_section( void );
 
 
+/******************************************************************************
+ * Save the interrupt state and disable interrupts
+ *
+ * Unlike hkos_hal_enter_critical_section, it can be called with interrupts
+ * disabled, e.g. from an interrupt service routine, because
+ * hkos_hal_irq_restore only enables the interrupts if they were enabled.
+ *
+ * OBS: this function must not be called by user code. All use of this
+ * function MUST be restricted to HalfKOS core.
+ *
+ * @return  The interrupt state before the call, not 0 if the interrupts
+ *          were enabled
+ *
+ *****************************************************************************/
+hkos_irq_state_t hkos_hal_irq_save( void );
+
+
+/******************************************************************************
+ * Restore the interrupt state saved by hkos_hal_irq_save
+ *
+ * @param[in]   state       The state returned by hkos_hal_irq_save
+ *
+ *****************************************************************************/
+void hkos_hal_irq_restore( hkos_irq_state_t state );
+
+
+/******************************************************************************
+ * Get the time elapsed since the last tick
+ *
+ * Used to measure time with a resolution finer than the tick. The HAL
+ * defines HKOS_HAL_TICK_FRACTIONS, the number of fractions in a tick,
+ * which must be below 2^14.
+ *
+ * If the tick timer interrupt is pending, the tick counter is behind and
+ * the result must be greater than or equal to HKOS_HAL_TICK_FRACTIONS.
+ *
+ * @return  Time since the last tick in 1/HKOS_HAL_TICK_FRACTIONS of a tick
+ *
+ *****************************************************************************/
+uint16_t hkos_hal_get_tick_fraction( void );
+
+
+/******************************************************************************
+ * Get the program counter saved in the context of a task
+ *
+ * Called from hkos_scheduler_tick_timer for the running task, whose context
+ * has just been saved by the tick timer interrupt.
+ *
+ * @param[in]   p_sp        The stack pointer saved in the task structure
+ *
+ * @return  The address the task was executing when it was interrupted
+ *
+ *****************************************************************************/
+uintptr_t hkos_hal_get_saved_pc( void* p_sp );
+
+
+/******************************************************************************
+ * Get the cycle counter
+ *
+ * A free-running counter of CPU clock cycles, or as close as the hardware
+ * allows. It wraps around at 2^32, so only differences are meaningful.
+ * Called with interrupts disabled.
+ *
+ * @return  The cycle counter
+ *
+ *****************************************************************************/
+uint32_t hkos_hal_get_cycles( void );
+
+
+#if HKOS_IRQ_STATS
+/******************************************************************************
+ * Get the interrupt statistics
+ *
+ * The HAL measures the time between hkos_hal_enter_critical_section (or
+ * hkos_hal_irq_save, if it disables the interrupts) and the call that
+ * enables the interrupts again. It also measures the latency of a periodic
+ * test interrupt.
+ *
+ * @param[out]  p_stats     The statistics
+ *
+ *****************************************************************************/
+void hkos_hal_get_irq_stats( hkos_irq_stats_t* p_stats );
+
+
+/******************************************************************************
+ * Discard the interrupt statistics
+ *
+ *****************************************************************************/
+void hkos_hal_reset_irq_stats( void );
+#endif
+
+
 #endif // __HKOS_HAL_H
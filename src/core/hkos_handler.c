@@ -0,0 +1,108 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+#include <stddef.h>
+#include <hkos_hal.h>
+#include <hkos_scheduler.h>
+#include <hkos_handler.h>
+
+// Event handlers are only available when enabled in hkos_config.h
+#if HKOS_HANDLERS_ENABLE > 0
+
+// Kernel work queue, which runs the handlers
+static HKOS_INSTANCE_LOCAL hkos_workqueue_t* p_handler_wq;
+
+/******************************************************************************
+ * Initialize the event handlers
+ *
+ * Creates the kernel work queue. Called by hkos_init.
+ *
+ *****************************************************************************/
+void hkos_handler_init( void ) {
+    p_handler_wq = hkos_workqueue_create( HKOS_HANDLER_STACK );
+}
+
+/******************************************************************************
+ * Create an event handler
+ *
+ * @param[in]   p_func          Function called each time the handler runs
+ * @param[in]   p_arg           Argument passed to the function
+ *
+ * @return  Pointer to the handler structure or NULL if it cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_handler_create( hkos_handler_func_t p_func, void* p_arg ) {
+
+    if ( p_func == NULL || p_handler_wq == NULL )
+        return NULL;
+
+    hkos_hal_enter_critical_section();
+    hkos_handler_t* p_handler = hkos_scheduler_alloc( sizeof(hkos_handler_t) );
+    hkos_hal_exit_critical_section();
+
+    if ( p_handler != NULL ) {
+        p_handler->work.p_next = NULL;
+        p_handler->work.p_func = p_func;
+        p_handler->work.p_arg = p_arg;
+        p_handler->work.queued = false;
+    }
+
+    return p_handler;
+}
+
+/******************************************************************************
+ * Post an event to a handler
+ *
+ * @param[in]   p_handler   Pointer to the handler
+ *
+ *****************************************************************************/
+void hkos_handler_post( void* p_handler_in ) {
+
+    if ( p_handler_in != NULL ) {
+        hkos_handler_t* p_handler = (hkos_handler_t*)p_handler_in;
+
+        // the work item keeps the function and argument, so submitting them
+        // again changes nothing
+        hkos_work_submit( p_handler_wq,
+                          &p_handler->work,
+                          p_handler->work.p_func,
+                          p_handler->work.p_arg );
+    }
+}
+
+/******************************************************************************
+ * Destroy an event handler
+ *
+ * @param[in]   p_handler   Pointer to the handler
+ *
+ *****************************************************************************/
+void hkos_handler_destroy( void* p_handler ) {
+
+    if ( p_handler != NULL ) {
+        hkos_hal_enter_critical_section();
+        hkos_work_cancel( p_handler_wq, &((hkos_handler_t*)p_handler)->work );
+        hkos_scheduler_free( p_handler );
+        hkos_hal_exit_critical_section();
+    }
+}
+
+#endif // HKOS_HANDLERS_ENABLE > 0
@@ -0,0 +1,114 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+#ifndef __HKOS_HANDLER_H
+#define __HKOS_HANDLER_H
+
+#include <hkos_core.h>
+#include <hkos_config.h>
+
+// If HKOS_HANDLERS_ENABLE is not defined in hkos_config.h, define it as 0
+#ifndef HKOS_HANDLERS_ENABLE
+#define HKOS_HANDLERS_ENABLE            0
+#endif
+
+// Event handlers are only available when enabled in hkos_config.h
+#if HKOS_HANDLERS_ENABLE > 0
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <hkos_workqueue.h>
+
+#if HKOS_WORKQUEUES_ENABLE == 0
+#error "Event handlers run on a work queue, so they need HKOS_WORKQUEUES_ENABLE"
+#endif
+
+// Stack shared by all the event handlers
+#ifndef HKOS_HANDLER_STACK
+#define HKOS_HANDLER_STACK              48
+#endif
+
+// Event handler function
+typedef hkos_work_func_t hkos_handler_func_t;
+
+/******************************************************************************
+ * HalfKOS event handler structure
+ *
+ * Event handlers are run-to-completion jobs. They have no stack of their
+ * own: each one is a work item of the kernel work queue, so all of them
+ * run, one at a time, on the stack of its worker. Posting a handler that
+ * is already pending does nothing, so a handler runs once for any number
+ * of posts before it starts.
+ *
+ *****************************************************************************/
+typedef struct hkos_handler_t {
+    hkos_work_t             work;           // keeps the function and argument
+} hkos_handler_t;
+
+
+/******************************************************************************
+ * Create an event handler
+ *
+ * @param[in]   p_func          Function called each time the handler runs.
+ *                              It must not block.
+ * @param[in]   p_arg           Argument passed to the function
+ *
+ * @return  Pointer to the handler structure or NULL if it cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_handler_create( hkos_handler_func_t p_func, void* p_arg );
+
+
+/******************************************************************************
+ * Post an event to a handler
+ *
+ * The handler is submitted to the kernel work queue, so it runs with the
+ * latency described in hkos_work_submit. This function can be called from
+ * tasks, timer callbacks, other handlers and interrupt service routines.
+ *
+ * @param[in]   p_handler   Pointer to the handler
+ *
+ *****************************************************************************/
+void hkos_handler_post( void* p_handler );
+
+
+/******************************************************************************
+ * Destroy an event handler
+ *
+ * A pending event is discarded. A handler may destroy itself while running.
+ *
+ * @param[in]   p_handler   Pointer to the handler
+ *
+ *****************************************************************************/
+void hkos_handler_destroy( void* p_handler );
+
+
+/******************************************************************************
+ * Initialize the event handlers
+ *
+ * Creates the kernel work queue. Called by hkos_init.
+ *
+ *****************************************************************************/
+void hkos_handler_init( void );
+
+#endif // HKOS_HANDLERS_ENABLE > 0
+
+#endif //__HKOS_HANDLER_H
@@ -0,0 +1,116 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *
+ * Kernel hook points
+ *
+ * The kernel calls these macros at the points of interest of the scheduler.
+ * They are empty by default, so they cost nothing when unused. To plug in a
+ * profiler, a tracer or a power monitor, define the hooks of interest in
+ * hkos_config.h, e.g.:
+ *
+ *      #define HKOS_HOOK_TASK_SWITCHED_IN( p_task )    my_switch_in( p_task )
+ *
+ * The hooks run inside the kernel, most of them with interrupts disabled
+ * or in an ISR, so they must be short and must not call HalfKOS functions.
+ * The task pointers are the ones returned by hkos_add_task, NULL meaning
+ * the CPU is idle.
+ *
+ * When HKOS_TRACE is set, the default hooks record the trace events. A hook
+ * defined in hkos_config.h replaces the trace event, but it can call
+ * HKOS_TRACE_EVENT itself.
+ *
+ *****************************************************************************/
+#ifndef __HKOS_HOOKS_H
+#define __HKOS_HOOKS_H
+
+#include <hkos_config.h>
+#include <hkos_trace.h>
+
+// A task is about to leave the CPU (NULL for idle)
+#ifndef HKOS_HOOK_TASK_SWITCHED_OUT
+#define HKOS_HOOK_TASK_SWITCHED_OUT( p_task )   HKOS_TRACE_EVENT( HKOS_TRACE_SWITCH_OUT, p_task )
+#endif
+
+// A task is about to get the CPU (NULL for idle)
+#ifndef HKOS_HOOK_TASK_SWITCHED_IN
+#define HKOS_HOOK_TASK_SWITCHED_IN( p_task )    HKOS_TRACE_EVENT( HKOS_TRACE_SWITCH_IN, p_task )
+#endif
+
+// The CPU is about to go idle because no task is ready
+#ifndef HKOS_HOOK_IDLE
+#define HKOS_HOOK_IDLE()                        ( (void)0 )
+#endif
+
+// A task is added to the ready list
+#ifndef HKOS_HOOK_TASK_READY
+#define HKOS_HOOK_TASK_READY( p_task )          HKOS_TRACE_EVENT( HKOS_TRACE_READY, p_task )
+#endif
+
+// The running task is suspended for some ticks or until signalled
+#ifndef HKOS_HOOK_TASK_BLOCK
+#define HKOS_HOOK_TASK_BLOCK( p_task )          HKOS_TRACE_EVENT( HKOS_TRACE_BLOCK, p_task )
+#endif
+
+// The running task blocks because the mutex is locked
+#ifndef HKOS_HOOK_MUTEX_BLOCK
+#define HKOS_HOOK_MUTEX_BLOCK( p_mutex, p_task ) HKOS_TRACE_EVENT( HKOS_TRACE_BLOCK, p_task )
+#endif
+
+// The running task got the mutex
+#ifndef HKOS_HOOK_MUTEX_LOCK
+#define HKOS_HOOK_MUTEX_LOCK( p_mutex )         HKOS_TRACE_EVENT( HKOS_TRACE_MUTEX_LOCK, p_mutex )
+#endif
+
+// The running task released the mutex
+#ifndef HKOS_HOOK_MUTEX_UNLOCK
+#define HKOS_HOOK_MUTEX_UNLOCK( p_mutex )       HKOS_TRACE_EVENT( HKOS_TRACE_MUTEX_UNLOCK, p_mutex )
+#endif
+
+// The tick counter was incremented
+#ifndef HKOS_HOOK_TICK
+#define HKOS_HOOK_TICK( ticks )                 ( (void)0 )
+#endif
+
+// A memory block of size bytes, header included, was allocated (p_mem is
+// NULL if it failed)
+#ifndef HKOS_HOOK_MALLOC
+#define HKOS_HOOK_MALLOC( p_mem, size )         HKOS_TRACE_EVENT( HKOS_TRACE_ALLOC, p_mem )
+#endif
+
+// A memory block is being freed
+#ifndef HKOS_HOOK_FREE
+#define HKOS_HOOK_FREE( p_mem )                 HKOS_TRACE_EVENT( HKOS_TRACE_FREE, p_mem )
+#endif
+
+// An interrupt serviced by the port started (vector is the interrupt vector)
+#ifndef HKOS_HOOK_ISR_ENTER
+#define HKOS_HOOK_ISR_ENTER( vector )           HKOS_TRACE_EVENT( HKOS_TRACE_ISR_ENTER, vector )
+#endif
+
+// An interrupt serviced by the port is about to return
+#ifndef HKOS_HOOK_ISR_EXIT
+#define HKOS_HOOK_ISR_EXIT( vector )            HKOS_TRACE_EVENT( HKOS_TRACE_ISR_EXIT, vector )
+#endif
+
+#endif //__HKOS_HOOKS_H
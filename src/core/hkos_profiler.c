@@ -0,0 +1,403 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/**************************************************************************
+ *
+ * Statistical PC-sampling profiler
+ *
+ * At every tick, the PC of the running task is taken from the context saved
+ * by the tick timer interrupt and counted in a small hash table indexed by
+ * the task and the PC. Open addressing is used, so an entry is never freed
+ * until the profiler is reset.
+ *
+ * Code region profiling
+ *
+ * hkos_prof_begin and hkos_prof_end read the cycle counter of the HAL and
+ * keep the count, minimum, maximum and total of each region.
+ *
+ * ************************************************************************/
+#include <stddef.h>
+#include <hkos_hal.h>
+#include <hkos_profiler.h>
+#include <hkos_scheduler.h>
+#include <core/peripherals/serial/hkos_serial_hal.h>
+
+#if ( HKOS_PROFILER || HKOS_PROF_REGIONS > 0 ) && HKOS_SERIAL_PORTS_ENABLE > 0
+/**************************************************************************
+ * Helper function to print a number in hexadecimal, preceded by a space
+ *
+ * @param[in]       port            The serial port
+ * @param[in]       value           The number
+ *
+ * ************************************************************************/
+static void print_hex( uint8_t port, uint32_t value ) {
+
+    char text[ 2 * sizeof( value ) + 2 ];
+    uint8_t pos = sizeof( text ) - 1;
+
+    text[ pos ] = 0;
+    do {
+        text[ --pos ] = "0123456789abcdef"[ value & 0xF ];
+        value >>= 4;
+    } while ( value != 0 );
+    text[ --pos ] = ' ';
+
+    hkos_serial_print( port, &text[ pos ] );
+}
+#endif
+
+// The profiler is only available when enabled in hkos_config.h
+#if HKOS_PROFILER
+
+/******************************************************************************
+ * Profiler runtime data
+ *
+ *****************************************************************************/
+typedef struct hkos_profiler_data_t {
+    hkos_profiler_entry_t   entries[ HKOS_PROFILER_ENTRIES ];
+    hkos_profiler_stats_t   stats;
+} hkos_profiler_data_t;
+
+static HKOS_INSTANCE_LOCAL hkos_profiler_data_t profiler_data;
+
+/******************************************************************************
+ * Initialize the profiler
+ *
+ *****************************************************************************/
+void hkos_profiler_init( void ) {
+    hkos_profiler_reset();
+}
+
+/******************************************************************************
+ * Record a sample
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]   p_task      The running task or NULL if the CPU is idle
+ * @param[in]   pc          The PC of the running task
+ *
+ *****************************************************************************/
+void hkos_profiler_sample( void* p_task, uintptr_t pc ) {
+
+    ++profiler_data.stats.samples;
+
+    if ( p_task == NULL ) {
+        ++profiler_data.stats.idle;
+        return;
+    }
+
+    uint16_t task = (uint16_t)(uintptr_t)p_task;
+    pc &= ~(uintptr_t)( ( 1 << HKOS_PROFILER_SHIFT ) - 1 );
+
+    uint16_t index = (uint16_t)( ( pc >> HKOS_PROFILER_SHIFT ) ^ task )
+                        % HKOS_PROFILER_ENTRIES;
+
+    for ( uint16_t i = 0; i < HKOS_PROFILER_ENTRIES; ++i ) {
+        hkos_profiler_entry_t* p_entry = &profiler_data.entries[ index ];
+
+        if ( p_entry->count == 0 ) {
+            p_entry->pc = pc;
+            p_entry->task = task;
+        }
+
+        if ( p_entry->pc == pc && p_entry->task == task ) {
+            if ( p_entry->count < UINT16_MAX )
+                ++p_entry->count;
+            return;
+        }
+
+        index = ( index + 1 ) % HKOS_PROFILER_ENTRIES;
+    }
+
+    // the table is full
+    ++profiler_data.stats.missed;
+}
+
+/******************************************************************************
+ * Discard all the samples
+ *
+ *****************************************************************************/
+void hkos_profiler_reset( void ) {
+
+    hkos_irq_state_t state = hkos_hal_irq_save();
+
+    for ( uint16_t i = 0; i < HKOS_PROFILER_ENTRIES; ++i ) {
+        profiler_data.entries[i].count = 0;
+    }
+    profiler_data.stats.samples = 0;
+    profiler_data.stats.idle = 0;
+    profiler_data.stats.missed = 0;
+
+    hkos_hal_irq_restore( state );
+}
+
+/******************************************************************************
+ * Get an entry of the profiler table
+ *
+ * @param[in]   index       Index of the entry
+ * @param[out]  p_entry     The entry
+ *
+ * @return  false if the index is out of range
+ *
+ *****************************************************************************/
+bool hkos_profiler_get_entry( uint16_t index, hkos_profiler_entry_t* p_entry ) {
+
+    if ( index >= HKOS_PROFILER_ENTRIES )
+        return false;
+
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    *p_entry = profiler_data.entries[ index ];
+    hkos_hal_irq_restore( state );
+
+    return true;
+}
+
+/******************************************************************************
+ * Get the profiler statistics
+ *
+ * @param[out]  p_stats     The statistics
+ *
+ *****************************************************************************/
+void hkos_profiler_get_stats( hkos_profiler_stats_t* p_stats ) {
+
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    *p_stats = profiler_data.stats;
+    hkos_hal_irq_restore( state );
+}
+
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+
+/******************************************************************************
+ * Print the profiler table to a serial port
+ *
+ * @param[in]   port        The serial port, which must be open
+ *
+ *****************************************************************************/
+void hkos_profiler_dump( uint8_t port ) {
+
+    hkos_profiler_entry_t entry;
+    for ( uint16_t i = 0; hkos_profiler_get_entry( i, &entry ); ++i ) {
+        if ( entry.count > 0 ) {
+            hkos_serial_print( port, "P" );
+            print_hex( port, entry.task );
+            print_hex( port, entry.pc );
+            print_hex( port, entry.count );
+            hkos_serial_print( port, "\n" );
+        }
+    }
+
+    hkos_profiler_stats_t stats;
+    hkos_profiler_get_stats( &stats );
+    hkos_serial_print( port, "T" );
+    print_hex( port, stats.samples );
+    print_hex( port, stats.idle );
+    print_hex( port, stats.missed );
+    hkos_serial_print( port, "\n" );
+}
+#endif // HKOS_SERIAL_PORTS_ENABLE > 0
+
+#endif // HKOS_PROFILER
+
+// Code region profiling is only available when enabled in hkos_config.h
+#if HKOS_PROF_REGIONS > 0
+
+/******************************************************************************
+ * Code region runtime data
+ *
+ *****************************************************************************/
+typedef struct hkos_prof_region_t {
+    uint32_t                start;          // cycles at hkos_prof_begin
+    uint32_t                total;
+    uint32_t                min;
+    uint32_t                max;
+    uint16_t                count;
+} hkos_prof_region_t;
+
+typedef struct hkos_prof_data_t {
+    hkos_prof_region_t      regions[ HKOS_PROF_REGIONS ];
+    uint32_t                overhead;       // cycles of an empty region
+} hkos_prof_data_t;
+
+static HKOS_INSTANCE_LOCAL hkos_prof_data_t prof_data;
+
+/**************************************************************************
+ * Helper function to read the cycles of the running task
+ *
+ * With HKOS_PROF_EXCLUDE_OTHERS, it only advances while the running task
+ * is on the CPU. Otherwise, it is the cycle counter.
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @return  The cycles
+ *
+ * ************************************************************************/
+static uint32_t get_task_cycles( void ) {
+
+    uint32_t cycles = hkos_hal_get_cycles();
+
+#if HKOS_PROF_EXCLUDE_OTHERS
+    hkos_task_t* p_task = hkos_ram.runtime_data.p_running_task;
+    if ( p_task != NULL ) {
+        cycles = p_task->prof_cycles
+                    + ( cycles - hkos_ram.runtime_data.prof_last_switch );
+    }
+#endif
+
+    return cycles;
+}
+
+/******************************************************************************
+ * Initialize the code region profiling
+ *
+ *****************************************************************************/
+void hkos_prof_init( void ) {
+
+    hkos_prof_reset();
+
+    // measure an empty region, so its cost is not counted in the regions
+    prof_data.overhead = 0;
+    hkos_prof_begin( 0 );
+    hkos_prof_end( 0 );
+    prof_data.overhead = prof_data.regions[0].min;
+
+    hkos_prof_reset();
+}
+
+/******************************************************************************
+ * Start measuring a code region
+ *
+ * @param[in]   id          The region
+ *
+ *****************************************************************************/
+void hkos_prof_begin( uint8_t id ) {
+
+    if ( id < HKOS_PROF_REGIONS ) {
+        hkos_irq_state_t state = hkos_hal_irq_save();
+        prof_data.regions[ id ].start = get_task_cycles();
+        hkos_hal_irq_restore( state );
+    }
+}
+
+/******************************************************************************
+ * Finish measuring a code region
+ *
+ * @param[in]   id          The region
+ *
+ *****************************************************************************/
+void hkos_prof_end( uint8_t id ) {
+
+    if ( id < HKOS_PROF_REGIONS ) {
+        hkos_irq_state_t state = hkos_hal_irq_save();
+
+        hkos_prof_region_t* p_region = &prof_data.regions[ id ];
+
+        // unsigned arithmetic handles the counter wrapping around
+        uint32_t elapsed = get_task_cycles() - p_region->start;
+        elapsed = ( elapsed > prof_data.overhead ) ?
+                    elapsed - prof_data.overhead : 0;
+
+        if ( p_region->count == 0 || elapsed < p_region->min )
+            p_region->min = elapsed;
+        if ( p_region->count == 0 || elapsed > p_region->max )
+            p_region->max = elapsed;
+
+        // stop counting before the mean is corrupted
+        if ( p_region->count < UINT16_MAX &&
+             p_region->total <= UINT32_MAX - elapsed ) {
+            p_region->total += elapsed;
+            ++p_region->count;
+        }
+
+        hkos_hal_irq_restore( state );
+    }
+}
+
+/******************************************************************************
+ * Get the statistics of a code region
+ *
+ * @param[in]   id          The region
+ * @param[out]  p_stats     The statistics
+ *
+ * @return  false if the id is out of range
+ *
+ *****************************************************************************/
+bool hkos_prof_get_stats( uint8_t id, hkos_prof_stats_t* p_stats ) {
+
+    if ( id >= HKOS_PROF_REGIONS )
+        return false;
+
+    hkos_irq_state_t state = hkos_hal_irq_save();
+
+    hkos_prof_region_t* p_region = &prof_data.regions[ id ];
+    p_stats->count = p_region->count;
+    p_stats->min = p_region->min;
+    p_stats->max = p_region->max;
+    p_stats->mean = ( p_region->count > 0 ) ?
+                        p_region->total / p_region->count : 0;
+
+    hkos_hal_irq_restore( state );
+
+    return true;
+}
+
+/******************************************************************************
+ * Discard the statistics of all the code regions
+ *
+ *****************************************************************************/
+void hkos_prof_reset( void ) {
+
+    hkos_irq_state_t state = hkos_hal_irq_save();
+
+    for ( uint8_t id = 0; id < HKOS_PROF_REGIONS; ++id ) {
+        prof_data.regions[ id ].count = 0;
+        prof_data.regions[ id ].total = 0;
+        prof_data.regions[ id ].min = 0;
+        prof_data.regions[ id ].max = 0;
+    }
+
+    hkos_hal_irq_restore( state );
+}
+
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+/******************************************************************************
+ * Print the statistics of the code regions to a serial port
+ *
+ * @param[in]   port        The serial port, which must be open
+ *
+ *****************************************************************************/
+void hkos_prof_dump( uint8_t port ) {
+
+    hkos_prof_stats_t stats;
+    for ( uint8_t id = 0; hkos_prof_get_stats( id, &stats ); ++id ) {
+        if ( stats.count > 0 ) {
+            hkos_serial_print( port, "R" );
+            print_hex( port, id );
+            print_hex( port, stats.count );
+            print_hex( port, stats.min );
+            print_hex( port, stats.max );
+            print_hex( port, stats.mean );
+            hkos_serial_print( port, "\n" );
+        }
+    }
+}
+#endif // HKOS_SERIAL_PORTS_ENABLE > 0
+
+#endif // HKOS_PROF_REGIONS > 0
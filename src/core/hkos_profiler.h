@@ -0,0 +1,234 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+#ifndef __HKOS_PROFILER_H
+#define __HKOS_PROFILER_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <hkos_core.h>
+#include <hkos_config.h>
+
+// If HKOS_PROFILER is not defined in hkos_config.h, define it as 0
+#ifndef HKOS_PROFILER
+#define HKOS_PROFILER                   0
+#endif
+
+// The profiler is only available when enabled in hkos_config.h
+#if HKOS_PROFILER
+
+#if !HKOS_PREEMPTION
+#error "HKOS_PROFILER requires HKOS_PREEMPTION, as the PC is sampled from the saved context"
+#endif
+
+// Number of entries in the profiler table. The table is a global variable,
+// so its size must be taken out of HKOS_AVAILABLE_RAM.
+#ifndef HKOS_PROFILER_ENTRIES
+#define HKOS_PROFILER_ENTRIES           16
+#endif
+
+// Samples whose PC differ only in the lowest HKOS_PROFILER_SHIFT bits share
+// an entry. Larger values need fewer entries but blur the result.
+#ifndef HKOS_PROFILER_SHIFT
+#define HKOS_PROFILER_SHIFT             2
+#endif
+
+/******************************************************************************
+ * HalfKOS profiler entry
+ *
+ * Number of ticks in which the task was running the code at pc. The task is
+ * the lowest 16 bits of its address and pc is the start of the
+ * 2^HKOS_PROFILER_SHIFT bytes region. An entry whose count is 0 is empty.
+ *
+ *****************************************************************************/
+typedef struct hkos_profiler_entry_t {
+    uintptr_t               pc;
+    uint16_t                task;
+    uint16_t                count;
+} hkos_profiler_entry_t;
+
+/******************************************************************************
+ * HalfKOS profiler statistics
+ *
+ *****************************************************************************/
+typedef struct hkos_profiler_stats_t {
+    uint32_t                samples;        // ticks sampled
+    uint32_t                idle;           // ticks in which the CPU was idle
+    uint32_t                missed;         // samples with no free entry
+} hkos_profiler_stats_t;
+
+
+/******************************************************************************
+ * Initialize the profiler
+ *
+ * Called by hkos_init.
+ *
+ *****************************************************************************/
+void hkos_profiler_init( void );
+
+
+/******************************************************************************
+ * Record a sample
+ *
+ * Called by the scheduler at every tick.
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]   p_task      The running task or NULL if the CPU is idle
+ * @param[in]   pc          The PC of the running task
+ *
+ *****************************************************************************/
+void hkos_profiler_sample( void* p_task, uintptr_t pc );
+
+
+/******************************************************************************
+ * Discard all the samples
+ *
+ *****************************************************************************/
+void hkos_profiler_reset( void );
+
+
+/******************************************************************************
+ * Get an entry of the profiler table
+ *
+ * @param[in]   index       Index of the entry, from 0 to
+ *                          HKOS_PROFILER_ENTRIES - 1
+ * @param[out]  p_entry     The entry
+ *
+ * @return  false if the index is out of range
+ *
+ *****************************************************************************/
+bool hkos_profiler_get_entry( uint16_t index, hkos_profiler_entry_t* p_entry );
+
+
+/******************************************************************************
+ * Get the profiler statistics
+ *
+ * @param[out]  p_stats     The statistics
+ *
+ *****************************************************************************/
+void hkos_profiler_get_stats( hkos_profiler_stats_t* p_stats );
+
+
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+/******************************************************************************
+ * Print the profiler table to a serial port
+ *
+ * Prints one line for each entry, "P <task> <pc> <count>", and a last line
+ * with the statistics, "T <samples> <idle> <missed>", all in hexadecimal.
+ * tools/hkos_prof.py reads this output and maps the PCs to functions.
+ *
+ * @param[in]   port        The serial port, which must be open
+ *
+ *****************************************************************************/
+void hkos_profiler_dump( uint8_t port );
+#endif
+
+#endif // HKOS_PROFILER
+
+// Code region profiling is only available when enabled in hkos_config.h
+#if HKOS_PROF_REGIONS > 0
+
+/******************************************************************************
+ * Code region statistics
+ *
+ * All the times are in cycles of hkos_hal_get_cycles. The time spent in
+ * hkos_prof_begin and hkos_prof_end is not included. Without
+ * HKOS_PROF_EXCLUDE_OTHERS, the time other tasks ran while the region was
+ * preempted is included. ISRs are always included.
+ *
+ *****************************************************************************/
+typedef struct hkos_prof_stats_t {
+    uint16_t                count;          // times the region was measured
+    uint32_t                min;
+    uint32_t                max;
+    uint32_t                mean;
+} hkos_prof_stats_t;
+
+
+/******************************************************************************
+ * Initialize the code region profiling
+ *
+ * Called by hkos_init.
+ *
+ *****************************************************************************/
+void hkos_prof_init( void );
+
+
+/******************************************************************************
+ * Start measuring a code region
+ *
+ * A region must not be entered again, or by another task, before
+ * hkos_prof_end is called for it.
+ *
+ * @param[in]   id          The region, from 0 to HKOS_PROF_REGIONS - 1
+ *
+ *****************************************************************************/
+void hkos_prof_begin( uint8_t id );
+
+
+/******************************************************************************
+ * Finish measuring a code region
+ *
+ * Must be called by the task that called hkos_prof_begin.
+ *
+ * @param[in]   id          The region, from 0 to HKOS_PROF_REGIONS - 1
+ *
+ *****************************************************************************/
+void hkos_prof_end( uint8_t id );
+
+
+/******************************************************************************
+ * Get the statistics of a code region
+ *
+ * @param[in]   id          The region, from 0 to HKOS_PROF_REGIONS - 1
+ * @param[out]  p_stats     The statistics
+ *
+ * @return  false if the id is out of range
+ *
+ *****************************************************************************/
+bool hkos_prof_get_stats( uint8_t id, hkos_prof_stats_t* p_stats );
+
+
+/******************************************************************************
+ * Discard the statistics of all the code regions
+ *
+ *****************************************************************************/
+void hkos_prof_reset( void );
+
+
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+/******************************************************************************
+ * Print the statistics of the code regions to a serial port
+ *
+ * Prints one line for each measured region, "R <id> <count> <min> <max>
+ * <mean>", all in hexadecimal.
+ *
+ * @param[in]   port        The serial port, which must be open
+ *
+ *****************************************************************************/
+void hkos_prof_dump( uint8_t port );
+#endif
+
+#endif // HKOS_PROF_REGIONS > 0
+
+#endif //__HKOS_PROFILER_H
@@ -28,22 +28,28 @@
 #include <hkos_core.h>
 #include <hkos_hal.h>
 #include <hkos_scheduler.h>
+#include <hkos_timer.h>
+#include <hkos_hooks.h>
+#include <hkos_profiler.h>
 #include <hkos_config.h>
+#include <core/peripherals/serial/hkos_serial_hal.h>
 
 // General Macros
 //
 #define align(x)                    ( ( typeof( x ) )( ( size_t )( x + alignof(max_align_t) - 1 ) \
                                         & ( size_t )( ~( alignof(max_align_t) -1 ) ) ) )
 
-#define HKOS_DELAY_UNCHANGED        (~HKOS_WAIT_FOREVER) // Any value different from HKOS_WAIT_FOREVER will do
+#define HKOS_DELAY_UNCHANGED        ((uint32_t)~HKOS_WAIT_FOREVER) // Any value different from HKOS_WAIT_FOREVER will do
+
+#define STACK_CANARY                0xC5A3
 
 /******************************************************************************
  * RAM buffer definition
  *****************************************************************************/
-hkos_ram_t hkos_ram;
+HKOS_INSTANCE_LOCAL hkos_ram_t hkos_ram;
 
 /**************************************************************************
- * Helper function to allocate a memory in the HKOS RAM buffer
+ * Allocate a memory block in the HKOS RAM buffer
  *
  * This is Naive implementation focused on reducing the control block
  * overhead (no pointers to previous block).
@@ -56,7 +62,7 @@ hkos_ram_t hkos_ram;
  * @return Address of the block or NULL
  *
  * ************************************************************************/
-static void* mem_alloc( hkos_dmem_header_t size ) {
+void* hkos_scheduler_alloc( hkos_dmem_header_t size ) {
 
     // we always search from the beginning because of our minimal block header
     // Also, the first block is always aligned
@@ -93,13 +99,15 @@ static void* mem_alloc( hkos_dmem_header_t size ) {
         }
     }
 
+    HKOS_HOOK_MALLOC( address, size );
+
     // no block available for the requested size
     return address;
 
 }
 
 /**************************************************************************
- * Helper function to free a memory block in the HKOS RAM buffer
+ * Free a memory block in the HKOS RAM buffer
  *
  * This is Naive implementation focused on reducing the control block
  * overhead (no pointers to previous block).
@@ -109,10 +117,12 @@ static void* mem_alloc( hkos_dmem_header_t size ) {
  *
  * @param[in]   p_mem       pointer to the memory being freed
  *
- * TODO: Allow configuring mem_free to clear the freed memory region
+ * TODO: Allow configuring hkos_scheduler_free to clear the freed memory region
  *
  * ************************************************************************/
-static void mem_free( void* p_mem ) {
+void hkos_scheduler_free( void* p_mem ) {
+
+    HKOS_HOOK_FREE( p_mem );
 
     // the header comes before the block first user address
     p_mem -= sizeof(hkos_dmem_header_t);
@@ -196,6 +206,7 @@ static void add_task_to_head( hkos_task_t* p_task, hkos_task_t** pp_head ) {
 
     // Add the task to the head of the list
     p_task->p_next = *pp_head;
+    p_task->pp_list = pp_head;
     *pp_head = p_task;
 }
 
@@ -226,6 +237,7 @@ static void add_task_to_tail( hkos_task_t* p_task, hkos_task_t** pp_head ) {
 
     // task is the new tail
     p_task->p_next = NULL;
+    p_task->pp_list = pp_head;
 }
 
 /**************************************************************************
@@ -253,6 +265,86 @@ static void remove_task_from_list( hkos_task_t* p_task, hkos_task_t** pp_head )
 
     // remove links from the task
     p_task->p_next = NULL;
+    if ( p_task->pp_list == pp_head )
+        p_task->pp_list = NULL;
+}
+
+#if HKOS_SCHED_PRIORITY
+/**************************************************************************
+ * Helper function to insert a task in the ready list by effective priority
+ *
+ * Tasks with the same effective priority are kept in the order they were
+ * inserted.
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_task          The task to be inserted
+ *
+ * ************************************************************************/
+static void insert_by_priority( hkos_task_t* p_task ) {
+    hkos_task_t** pp_pos = &hkos_ram.runtime_data.p_ready_tasks;
+
+    while ( *pp_pos != NULL &&
+            (*pp_pos)->eff_priority >= p_task->eff_priority ) {
+        pp_pos = &(*pp_pos)->p_next;
+    }
+
+    p_task->p_next = *pp_pos;
+    p_task->pp_list = &hkos_ram.runtime_data.p_ready_tasks;
+    *pp_pos = p_task;
+}
+
+/**************************************************************************
+ * Helper function to check if a task is in the ready list
+ *
+ * @param[in]       p_task          The task to be checked
+ *
+ * @return      true if the task is ready
+ *
+ * ************************************************************************/
+static inline bool is_ready( hkos_task_t* p_task ) {
+    return p_task->pp_list == &hkos_ram.runtime_data.p_ready_tasks;
+}
+#endif
+
+/**************************************************************************
+ * Helper function to add a task to the ready list
+ *
+ * With HKOS_SCHED_EDF, the ready list is kept sorted by absolute deadline,
+ * with the tasks without deadline after the periodic ones. Tasks with the
+ * same deadline are kept in the order they became ready.
+ *
+ * With HKOS_SCHED_PRIORITY, a task becoming ready goes back to its own
+ * priority. It is raised to its preemption threshold only when dispatched.
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_task          The task to be added
+ *
+ * ************************************************************************/
+static void make_ready( hkos_task_t* p_task ) {
+
+    HKOS_HOOK_TASK_READY( p_task );
+
+#if HKOS_SCHED_PRIORITY
+    p_task->eff_priority = p_task->priority;
+    insert_by_priority( p_task );
+#elif HKOS_SCHED_EDF
+    hkos_task_t** pp_pos = &hkos_ram.runtime_data.p_ready_tasks;
+
+    while ( *pp_pos != NULL && (*pp_pos)->has_deadline &&
+            ( !p_task->has_deadline ||
+              hkos_tick_reached( p_task->deadline, (*pp_pos)->deadline ) ) ) {
+        pp_pos = &(*pp_pos)->p_next;
+    }
+
+    p_task->p_next = *pp_pos;
+    p_task->pp_list = &hkos_ram.runtime_data.p_ready_tasks;
+    *pp_pos = p_task;
+#else
+    // It is a round-robin. So, it doesn't matter where you add the task
+    add_task_to_head( p_task, &hkos_ram.runtime_data.p_ready_tasks );
+#endif
 }
 
 /**************************************************************************
@@ -290,7 +382,7 @@ static void update_blocked( void ) {
             // changed when calling sleep forever, it is because the event happened.
             task->delay_ticks = HKOS_DELAY_UNCHANGED;
             remove_task_from_list( task, &hkos_ram.runtime_data.p_blocked_tasks );
-            add_task_to_head( task, &hkos_ram.runtime_data.p_ready_tasks );
+            make_ready( task );
             task = next;
         } else {
             task = task->p_next;
@@ -310,6 +402,17 @@ void hkos_scheduler_init( void ) {
     hkos_ram.runtime_data.p_next_task = NULL;
     hkos_ram.runtime_data.p_ready_tasks = NULL;
     hkos_ram.runtime_data.p_blocked_tasks = NULL;
+    hkos_ram.runtime_data.p_zombie = NULL;
+    hkos_ram.runtime_data.ticks = 0;
+#if HKOS_SWITCH_COUNTER
+    hkos_ram.runtime_data.switches = 0;
+#endif
+#if HKOS_TASK_STATS
+    hkos_ram.runtime_data.idle_time = (hkos_run_time_t){ 0, 0 };
+    hkos_ram.runtime_data.last_switch = (hkos_run_time_t){ 0, 0 };
+    hkos_ram.runtime_data.load_start = (hkos_run_time_t){ 0, 0 };
+    hkos_ram.runtime_data.load_idle = (hkos_run_time_t){ 0, 0 };
+#endif
 
     // all memory is free
     hkos_ram_block_t *first_block = (hkos_ram_block_t*) align(&hkos_ram.dynamic_buffer[0]);
@@ -319,68 +422,437 @@ void hkos_scheduler_init( void ) {
                                 (size_t)&hkos_ram.dynamic_buffer[0]);
 }
 
+/**************************************************************************
+ * Helper function to get the top of a task stack
+ *
+ * The stack grows down from the end of the memory block of the task. The
+ * block may be a little larger than requested, so this is never before
+ * the end of the requested memory.
+ *
+ * @param[in]       p_task          The task
+ *
+ * @return      Address right after the memory block of the task
+ *
+ * ************************************************************************/
+static uint8_t* stack_top( hkos_task_t* p_task ) {
+    hkos_ram_block_t* p_block = (hkos_ram_block_t*)
+                        ( (uint8_t*)p_task - sizeof(hkos_dmem_header_t) );
+
+    return (uint8_t*)p_block + p_block->header.size;
+}
+
+#if HKOS_STACK_CHECK
+/**************************************************************************
+ * Helper function to put the canary right below a task stack
+ *
+ * @param[in]       p_task          The task
+ * @param[in]       stack_size      Size of the task's stack
+ *
+ * ************************************************************************/
+static void set_canary( hkos_task_t* p_task, hkos_size_t stack_size ) {
+    uintptr_t canary = (uintptr_t)( stack_top( p_task ) - stack_size
+                                    - hkos_hal_get_min_stack_size()
+                                    - sizeof(uint16_t) );
+
+    p_task->p_canary = (uint16_t*)( canary & ~(uintptr_t)( alignof(uint16_t) - 1 ) );
+    *p_task->p_canary = STACK_CANARY;
+}
+
+/**************************************************************************
+ * Helper function to check if a task overflowed its stack
+ *
+ * Called right after the context of the task is saved, so its saved stack
+ * pointer is the deepest the task is now.
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_task          The task leaving the CPU
+ *
+ * ************************************************************************/
+static inline void check_stack( hkos_task_t* p_task ) {
+    if ( (uint16_t*)p_task->p_sp <= p_task->p_canary ||
+         *p_task->p_canary != STACK_CANARY ) {
+        hkos_stack_overflow_hook( p_task );
+    }
+}
+
 /******************************************************************************
- * Add a task to HalfKOS scheduler
+ * Called when a task overflows its stack
+ *
+ * The memory right below the stack was corrupted, so there is no safe way
+ * to go on. This default hangs here to debug.
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ *
+ *****************************************************************************/
+void __attribute__((weak)) hkos_stack_overflow_hook( void* p_task ) {
+    while(1);
+}
+#endif
+
+/******************************************************************************
+ * Create a task without making it ready
  *
  * HalfKOS uses dynamic memory allocation, so this function also allocates
- * memory for the task being added.
+ * memory for the task being created.
  * Size of each task is stack_size + size of the task structure.
  *
  * @param[in]   p_task_func     Pointer to the task address
+ * @param[in]   p_arg           Argument passed to the task function
  * @param[in]   stack_size      Size of the task's size
+ * @param[in]   task_size       Size of the task structure, which may extend
+ *                              hkos_task_t
  *
  * @return  Pointer to the task structure or NULL if task cannot be created.
  *
  *****************************************************************************/
-void* hkos_scheduler_add_task( void (*p_task_func)(), hkos_size_t stack_size ) {
-
+void* hkos_scheduler_create_task( void (*p_task_func)(),
+                                  void* p_arg,
+                                  hkos_size_t stack_size,
+                                  hkos_size_t task_size )
+{
     // Allocate memory for the stack
     // In that memory region, besides the size requested by the user, we also
     // store the task data and the context switch data.
     // This reduces the number of memory blocks per task and, therefore,
     // the ram memory byte count per task
-    hkos_size_t total_size = stack_size + sizeof(hkos_task_t) +
+    hkos_size_t total_size = stack_size + task_size +
                                  hkos_hal_get_min_stack_size();
 
-    hkos_task_t* p_task = (hkos_task_t*)mem_alloc( total_size );
+#if HKOS_STACK_CHECK
+    // room for the canary
+    total_size += sizeof(uint16_t);
+#endif
+
+    hkos_task_t* p_task = (hkos_task_t*)hkos_scheduler_alloc( total_size );
 
     if ( p_task != NULL ) {
         // Initialize the delay_ticks.
         p_task->delay_ticks = HKOS_DELAY_UNCHANGED;
+        p_task->pp_list = NULL;
+
+#if HKOS_SCHED_EDF
+        // only periodic tasks have deadlines
+        p_task->has_deadline = false;
+#endif
+
+#if HKOS_PER_TASK_TIME_SLICE
+        p_task->time_slice = HKOS_MS_TO_TICKS( HKOS_TIME_SLICE );
+        p_task->preemptions = 0;
+#endif
+
+#if HKOS_SCHED_PRIORITY
+        p_task->priority = HKOS_DEFAULT_PRIORITY;
+        p_task->threshold = HKOS_DEFAULT_PRIORITY;
+#endif
+
+#if HKOS_TASK_STATS
+        p_task->stats = (hkos_task_stats_t){ { 0, 0 }, 0, 0 };
+#endif
+
+#if HKOS_TASK_RESTART
+        p_task->p_entry = p_task_func;
+        p_task->p_arg = p_arg;
+#endif
+
+#if HKOS_TASK_RESTART || HKOS_PAINT_TASK_STACK
+        p_task->stack_size = stack_size;
+#endif
+
+#if HKOS_STACK_CHECK
+        set_canary( p_task, stack_size );
+#endif
+
+#if HKOS_PROF_REGIONS > 0 && HKOS_PROF_EXCLUDE_OTHERS
+        p_task->prof_cycles = 0;
+#endif
 
         // initialize the stack pointer at the top of task's memory
-        p_task->p_sp = ( (uint8_t*)p_task ) + total_size;
+        p_task->p_sp = stack_top( p_task );
 
         // Initialize the stack content and update the stack pointer
         if ( NULL != ( p_task->p_sp = hkos_hal_init_stack(
-                                            p_task->p_sp, p_task_func, stack_size
+                                            p_task->p_sp, p_task_func, p_arg, stack_size
                                         ) ) )
         {
-            // It is a round-robin. So, it doesn't matter where you add the task
-            hkos_hal_enter_critical_section();
-            add_task_to_head( p_task, &hkos_ram.runtime_data.p_ready_tasks );
-            hkos_hal_exit_critical_section();
             return p_task;
         }
 
         // if something goes wrong, free the memory
-        mem_free(p_task);
+        hkos_scheduler_free(p_task);
     }
 
     // return NULL in case of error
     return NULL;
 }
 
+/******************************************************************************
+ * Make a task created by hkos_scheduler_create_task ready
+ *
+ * @param[in]   p_task_in       Pointer to the task structure
+ *
+ *****************************************************************************/
+void hkos_scheduler_start_task( void* p_task_in ) {
+    hkos_hal_enter_critical_section();
+    make_ready( (hkos_task_t*)p_task_in );
+    hkos_hal_exit_critical_section();
+}
+
+/******************************************************************************
+ * Add a task to HalfKOS scheduler
+ *
+ * @param[in]   p_task_func     Pointer to the task address
+ * @param[in]   p_arg           Argument passed to the task function
+ * @param[in]   stack_size      Size of the task's size
+ *
+ * @return  Pointer to the task structure or NULL if task cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_scheduler_add_task( void (*p_task_func)(),
+                               void* p_arg,
+                               hkos_size_t stack_size )
+{
+    void* p_task = hkos_scheduler_create_task( p_task_func, p_arg, stack_size,
+                                               sizeof(hkos_task_t) );
+
+    if ( p_task != NULL )
+        hkos_scheduler_start_task( p_task );
+
+    return p_task;
+}
+
+/**************************************************************************
+ * Periodic task body
+ *
+ * Runs one job of the periodic task per period. The releases are absolute
+ * ticks, so the work time does not make the period drift.
+ *
+ * ************************************************************************/
+static void periodic_task( void ) {
+
+    hkos_periodic_task_t* p_task =
+        (hkos_periodic_task_t*)hkos_ram.runtime_data.p_running_task;
+
+    while ( 1 ) {
+        p_task->p_job();
+
+        hkos_hal_enter_critical_section();
+#if HKOS_SCHED_EDF
+        if ( !hkos_tick_reached( p_task->task.deadline, hkos_ram.runtime_data.ticks ) )
+            ++p_task->deadline_misses;
+
+        // the deadline must be set before sleeping, because the task is
+        // sorted in the ready list when it wakes up
+        p_task->task.deadline = p_task->release + p_task->period
+                                    + p_task->rel_deadline;
+#endif
+        if ( !hkos_scheduler_sleep_until( &p_task->release, p_task->period ) ) {
+            // The job was still running at its next release. That release
+            // runs now, but the ones that were missed entirely are skipped.
+            ++p_task->overruns;
+            while ( hkos_tick_reached( hkos_ram.runtime_data.ticks,
+                                       p_task->release + p_task->period ) ) {
+                p_task->release += p_task->period;
+            }
+#if HKOS_SCHED_EDF
+            // the task did not block, so it is sorted again here
+            p_task->task.deadline = p_task->release + p_task->rel_deadline;
+            remove_task_from_ready_list( &p_task->task );
+            make_ready( &p_task->task );
+#endif
+        }
+        hkos_hal_exit_critical_section();
+    }
+}
+
+/******************************************************************************
+ * Add a periodic task to HalfKOS scheduler
+ *
+ * @param[in]   p_job           Function executed once per period
+ * @param[in]   period          Period of the task in ticks
+ * @param[in]   stack_size      Size of the task's size
+ *
+ * @return  Pointer to the task structure or NULL if task cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_scheduler_add_periodic_task( void (*p_job)(),
+                                        hkos_tick_t period,
+                                        hkos_size_t stack_size )
+{
+    hkos_periodic_task_t* p_task = hkos_scheduler_create_task(
+                                        periodic_task, NULL, stack_size,
+                                        sizeof(hkos_periodic_task_t) );
+
+    if ( p_task != NULL ) {
+        p_task->p_job = p_job;
+        p_task->period = ( period > 0 ) ? period : 1;
+        p_task->release = hkos_ram.runtime_data.ticks;
+        p_task->overruns = 0;
+#if HKOS_SCHED_EDF
+        // implicit deadline: each job must finish before the next release
+        p_task->rel_deadline = p_task->period;
+        p_task->deadline_misses = 0;
+        p_task->task.deadline = p_task->release + p_task->rel_deadline;
+        p_task->task.has_deadline = true;
+#endif
+        hkos_scheduler_start_task( p_task );
+    }
+
+    return p_task;
+}
+
+#if HKOS_PER_TASK_TIME_SLICE
+/******************************************************************************
+ * Set the time slice of a task
+ *
+ * @param[in]   p_task_in       Pointer to the task structure
+ * @param[in]   time_slice      Time slice in ticks. 0 makes the task run
+ *                              until it blocks
+ *
+ *****************************************************************************/
+void hkos_scheduler_set_time_slice( void* p_task_in, uint16_t time_slice ) {
+
+    if ( p_task_in != NULL ) {
+        ((hkos_task_t*)p_task_in)->time_slice = time_slice;
+    }
+}
+#endif
+
+#if HKOS_SCHED_PRIORITY
+/******************************************************************************
+ * Set the priority and the preemption threshold of a task
+ *
+ * @param[in]   p_task_in       Pointer to the task structure
+ * @param[in]   priority        Priority of the task. Higher runs first
+ * @param[in]   threshold       Preemption threshold. It is raised to the
+ *                              priority if lower
+ *
+ *****************************************************************************/
+void hkos_scheduler_set_priority( void* p_task_in,
+                                  uint8_t priority,
+                                  uint8_t threshold )
+{
+    if ( p_task_in != NULL ) {
+        hkos_task_t* p_task = (hkos_task_t*)p_task_in;
+
+        hkos_hal_enter_critical_section();
+        p_task->priority = priority;
+        p_task->threshold = ( threshold > priority ) ? threshold : priority;
+
+        // the running task keeps its threshold. The other ready tasks are
+        // sorted again. A blocked task is sorted when it wakes up
+        if ( p_task == hkos_ram.runtime_data.p_running_task ) {
+            p_task->eff_priority = p_task->threshold;
+        } else {
+            p_task->eff_priority = p_task->priority;
+        }
+
+        if ( is_ready( p_task ) ) {
+            remove_task_from_ready_list( p_task );
+            insert_by_priority( p_task );
+        }
+        hkos_hal_exit_critical_section();
+    }
+}
+
+/******************************************************************************
+ * Move the running task behind the ready tasks with its effective priority
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ *****************************************************************************/
+void hkos_scheduler_rotate( void ) {
+    hkos_task_t* p_running = hkos_ram.runtime_data.p_running_task;
+
+    if ( p_running != NULL && is_ready( p_running ) ) {
+        remove_task_from_ready_list( p_running );
+        insert_by_priority( p_running );
+    }
+}
+#endif
+
+#if HKOS_SCHED_EDF
+/******************************************************************************
+ * Set the relative deadline of a periodic task
+ *
+ * @param[in]   p_task_in       Pointer to the task structure returned by
+ *                              hkos_scheduler_add_periodic_task
+ * @param[in]   deadline        Deadline in ticks relative to each release
+ *
+ *****************************************************************************/
+void hkos_scheduler_set_deadline( void* p_task_in, hkos_tick_t deadline ) {
+
+    if ( p_task_in != NULL ) {
+        hkos_periodic_task_t* p_task = (hkos_periodic_task_t*)p_task_in;
+
+        hkos_hal_enter_critical_section();
+        p_task->rel_deadline = deadline;
+        p_task->task.deadline = p_task->release + deadline;
+
+        // only a ready task needs to be sorted again. A blocked task is
+        // sorted when it wakes up
+        hkos_task_t* search = hkos_ram.runtime_data.p_ready_tasks;
+        for (; search != NULL && search != &p_task->task; search = search->p_next );
+
+        if ( search != NULL ) {
+            remove_task_from_ready_list( &p_task->task );
+            make_ready( &p_task->task );
+        }
+        hkos_hal_exit_critical_section();
+    }
+}
+#endif
+
+/**************************************************************************
+ * Helper function to take a task out of whatever list it is in
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_task          The task to be detached
+ *
+ * ************************************************************************/
+static void detach_task( hkos_task_t* p_task ) {
+
+    if ( p_task->pp_list == &hkos_ram.runtime_data.p_ready_tasks ) {
+        remove_task_from_ready_list( p_task );
+    } else if ( p_task->pp_list != NULL ) {
+        remove_task_from_list( p_task, p_task->pp_list );
+    }
+
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+    hkos_serial_forget_task( p_task );
+#endif
+}
+
+/**************************************************************************
+ * Helper function to free the memory of an exited task
+ *
+ * The task exited while running, so its memory could only be freed after
+ * it left the CPU.
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * ************************************************************************/
+static void free_zombie( void ) {
+    hkos_task_t* p_zombie = hkos_ram.runtime_data.p_zombie;
+
+    if ( p_zombie != NULL && p_zombie != hkos_ram.runtime_data.p_running_task ) {
+        hkos_scheduler_free( p_zombie );
+        hkos_ram.runtime_data.p_zombie = NULL;
+    }
+}
+
 /******************************************************************************
  * Remove a task from HalfKOS Scheduler
  *
  * Besides removing the task from Scheduler, it also frees the task memory.
+ * The task may be in the ready list, in the blocked list or waiting for a
+ * mutex or a serial port. A task removing itself is still running on its
+ * own stack, so its memory is freed only in the next context switch.
  *
  * @param[in]   p_task_in       Pointer to the task structure returned by
  *                              hkos_add_task
  *
- * TODO: What if the task to be removed is in a list other than running?
- *
  *****************************************************************************/
 void hkos_scheduler_remove_task( void* p_task_in ) {
 
@@ -389,17 +861,88 @@ void hkos_scheduler_remove_task( void* p_task_in ) {
         hkos_task_t* p_task = (hkos_task_t*)p_task_in;
 
         hkos_hal_enter_critical_section();
-        remove_task_from_ready_list( p_task );
-        mem_free(p_task);
-        hkos_hal_exit_critical_section();
+        detach_task( p_task );
+
+        // only one task can be waiting to be freed
+        free_zombie();
+
+        if ( p_task == hkos_ram.runtime_data.p_running_task ) {
+            hkos_ram.runtime_data.p_zombie = p_task;
+            hkos_hal_exit_critical_section();
+            // the task is in no list, so it never runs again
+            hkos_scheduler_yield();
+        } else {
+            hkos_scheduler_free( p_task );
+            hkos_hal_exit_critical_section();
+        }
     }
 }
 
+#if HKOS_TASK_RESTART
 /******************************************************************************
- * Execute a context switch
+ * Restart a task in its own memory block
+ *
+ * The stack is initialized again at the end of the memory block of the task.
+ * Mutexes locked by the task are not released.
+ *
+ * @param[in]   p_task_in       Pointer to the task structure returned by
+ *                              hkos_add_task
+ *
+ * @return  false if the task is the running one and cannot be restarted
+ *
+ *****************************************************************************/
+bool hkos_scheduler_restart_task( void* p_task_in ) {
+
+    hkos_task_t* p_task = (hkos_task_t*)p_task_in;
+
+    if ( p_task == NULL || p_task == hkos_ram.runtime_data.p_running_task ||
+         p_task == hkos_ram.runtime_data.p_zombie ) {
+        return false;
+    }
+
+    hkos_hal_enter_critical_section();
+    detach_task( p_task );
+
+    p_task->p_sp = hkos_hal_init_stack( stack_top( p_task ),
+                                        p_task->p_entry, p_task->p_arg,
+                                        p_task->stack_size );
+    p_task->delay_ticks = HKOS_DELAY_UNCHANGED;
+
+#if HKOS_STACK_CHECK
+    set_canary( p_task, p_task->stack_size );
+#endif
+
+    // a periodic task starts a new sequence of releases from now
+    if ( p_task->p_entry == periodic_task ) {
+        hkos_periodic_task_t* p_periodic = (hkos_periodic_task_t*)p_task;
+        p_periodic->release = hkos_ram.runtime_data.ticks;
+#if HKOS_SCHED_EDF
+        p_task->deadline = p_periodic->release + p_periodic->rel_deadline;
+#endif
+    }
+
+    make_ready( p_task );
+    hkos_hal_exit_critical_section();
+
+    return true;
+}
+#endif
+
+/******************************************************************************
+ * Remove the running task from HalfKOS Scheduler
  *
  * ************************************************************************/
-void hkos_scheduler_switch_context( void ) {
+void hkos_scheduler_exit_task( void ) {
+    hkos_scheduler_remove_task( hkos_ram.runtime_data.p_running_task );
+}
+
+/**************************************************************************
+ * Helper function to select the task to run in a context switch
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * ************************************************************************/
+static void select_next_task( void ) {
 
     if ( hkos_ram.runtime_data.p_ready_tasks == NULL ) {
         hkos_ram.runtime_data.p_running_task = NULL;
@@ -407,6 +950,29 @@ void hkos_scheduler_switch_context( void ) {
         return; // no task to run
     }
 
+#if HKOS_SCHED_PRIORITY
+    // The head has the highest effective priority. Once dispatched, it
+    // runs at its preemption threshold. Raising it keeps the task at the
+    // head of the list. A running task that is still ready keeps its place
+    // too, unless it yields or its time slice is over.
+    hkos_ram.runtime_data.p_running_task = hkos_ram.runtime_data.p_ready_tasks;
+    hkos_ram.runtime_data.p_running_task->eff_priority =
+                                hkos_ram.runtime_data.p_running_task->threshold;
+    hkos_ram.runtime_data.ticks_from_switch = 0;
+    return;
+#endif
+
+#if HKOS_SCHED_EDF
+    // The earliest deadline always runs first. The p_next_task is reset, so
+    // the round-robin restarts from the head when no periodic task is ready.
+    if ( hkos_ram.runtime_data.p_ready_tasks->has_deadline ) {
+        hkos_ram.runtime_data.p_running_task = hkos_ram.runtime_data.p_ready_tasks;
+        hkos_ram.runtime_data.p_next_task = NULL;
+        hkos_ram.runtime_data.ticks_from_switch = 0;
+        return;
+    }
+#endif
+
     hkos_ram.runtime_data.p_running_task = hkos_ram.runtime_data.p_next_task;
 
     if ( hkos_ram.runtime_data.p_running_task == NULL ) {
@@ -419,6 +985,209 @@ void hkos_scheduler_switch_context( void ) {
     hkos_ram.runtime_data.ticks_from_switch = 0;
 }
 
+#if HKOS_TASK_STATS
+/**************************************************************************
+ * Helper function to get the current time
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[out]      p_now           The current time
+ *
+ * ************************************************************************/
+static void get_time( hkos_run_time_t* p_now ) {
+    uint16_t fraction = hkos_hal_get_tick_fraction();
+
+    p_now->ticks = hkos_ram.runtime_data.ticks;
+
+    // the tick timer interrupt is pending, so the tick counter is behind
+    while ( fraction >= HKOS_HAL_TICK_FRACTIONS ) {
+        fraction -= HKOS_HAL_TICK_FRACTIONS;
+        ++p_now->ticks;
+    }
+
+    p_now->fraction = fraction;
+}
+
+/**************************************************************************
+ * Helper function to add the time between two instants to a total
+ *
+ * @param[inout]    p_total         The total time
+ * @param[in]       p_from          The first instant
+ * @param[in]       p_to            The second instant
+ *
+ * ************************************************************************/
+static void add_time( hkos_run_time_t* p_total,
+                      const hkos_run_time_t* p_from,
+                      const hkos_run_time_t* p_to )
+{
+    p_total->ticks += p_to->ticks - p_from->ticks;
+
+    if ( p_to->fraction >= p_from->fraction ) {
+        p_total->fraction += p_to->fraction - p_from->fraction;
+    } else {
+        p_total->fraction += HKOS_HAL_TICK_FRACTIONS + p_to->fraction
+                                - p_from->fraction;
+        --p_total->ticks;
+    }
+
+    if ( p_total->fraction >= HKOS_HAL_TICK_FRACTIONS ) {
+        p_total->fraction -= HKOS_HAL_TICK_FRACTIONS;
+        ++p_total->ticks;
+    }
+}
+
+/**************************************************************************
+ * Helper function to charge the CPU time to the task leaving the CPU
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_previous      The task leaving the CPU or NULL if idle
+ * @param[in]       preempted       true if the task was preempted
+ *
+ * ************************************************************************/
+static void account_switch( hkos_task_t* p_previous, bool preempted ) {
+    hkos_run_time_t now;
+    get_time( &now );
+
+    if ( p_previous == NULL ) {
+        add_time( &hkos_ram.runtime_data.idle_time,
+                  &hkos_ram.runtime_data.last_switch, &now );
+    } else {
+        add_time( &p_previous->stats.run_time,
+                  &hkos_ram.runtime_data.last_switch, &now );
+
+        if ( preempted ) {
+            ++p_previous->stats.preemptions;
+        } else {
+            ++p_previous->stats.voluntary_switches;
+        }
+    }
+
+    hkos_ram.runtime_data.last_switch = now;
+}
+#endif // HKOS_TASK_STATS
+
+/**************************************************************************
+ * Helper function to execute a context switch
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       preempted       true if called by the tick timer
+ *
+ * ************************************************************************/
+static void switch_task( bool preempted ) {
+
+    hkos_task_t* p_previous = hkos_ram.runtime_data.p_running_task;
+
+#if HKOS_STACK_CHECK
+    if ( p_previous != NULL )
+        check_stack( p_previous );
+#endif
+
+    // an exited task is never selected again, so it is off the CPU as soon
+    // as another task (or idle) is running
+    free_zombie();
+
+    select_next_task();
+
+    // a task that gets the CPU back did not switch
+    if ( hkos_ram.runtime_data.p_running_task == p_previous )
+        return;
+
+    HKOS_HOOK_TASK_SWITCHED_OUT( p_previous );
+    HKOS_HOOK_TASK_SWITCHED_IN( hkos_ram.runtime_data.p_running_task );
+    if ( hkos_ram.runtime_data.p_running_task == NULL )
+        HKOS_HOOK_IDLE();
+
+#if HKOS_SWITCH_COUNTER
+    ++hkos_ram.runtime_data.switches;
+#endif
+
+#if HKOS_PER_TASK_TIME_SLICE
+    if ( preempted && p_previous != NULL )
+        ++p_previous->preemptions;
+#endif
+
+#if HKOS_TASK_STATS
+    account_switch( p_previous, preempted );
+#endif
+
+#if HKOS_PROF_REGIONS > 0 && HKOS_PROF_EXCLUDE_OTHERS
+    // the regions of a task only count the cycles it is on the CPU
+    uint32_t cycles = hkos_hal_get_cycles();
+    if ( p_previous != NULL )
+        p_previous->prof_cycles += cycles - hkos_ram.runtime_data.prof_last_switch;
+    hkos_ram.runtime_data.prof_last_switch = cycles;
+#endif
+}
+
+/******************************************************************************
+ * Execute a context switch
+ *
+ * ************************************************************************/
+void hkos_scheduler_switch_context( void ) {
+    switch_task( false );
+}
+
+#if HKOS_PREEMPTION
+/**************************************************************************
+ * Helper function to preempt the running task
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * ************************************************************************/
+static void preempt( void ) {
+    switch_task( true );
+}
+
+#if HKOS_SCHED_PRIORITY || HKOS_SCHED_EDF
+/**************************************************************************
+ * Helper function to check if a ready task must preempt the running task
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_task          The ready task
+ * @param[in]       p_running       The running task, not NULL
+ *
+ * @return  true if the ready task must get the CPU
+ *
+ * ************************************************************************/
+static bool preempts( hkos_task_t* p_task, hkos_task_t* p_running ) {
+#if HKOS_SCHED_PRIORITY
+    // only a priority above the preemption threshold preempts
+    return p_task->eff_priority > p_running->eff_priority;
+#else
+    // only an earlier deadline preempts
+    return p_task->has_deadline &&
+           ( !p_running->has_deadline ||
+             !hkos_tick_reached( p_task->deadline, p_running->deadline ) );
+#endif
+}
+#endif
+
+/**************************************************************************
+ * Helper function to check if the running task used its time slice
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @return  true if the time slice is over
+ *
+ * ************************************************************************/
+static bool time_slice_over( void ) {
+#if HKOS_PER_TASK_TIME_SLICE
+    hkos_task_t* p_running = hkos_ram.runtime_data.p_running_task;
+
+    // idle uses the default time slice
+    if ( p_running != NULL ) {
+        return ( p_running->time_slice != 0 ) &&
+               ( hkos_ram.runtime_data.ticks_from_switch > p_running->time_slice );
+    }
+#endif
+    return hkos_ram.runtime_data.ticks_from_switch >
+                HKOS_MS_TO_TICKS( HKOS_TIME_SLICE );
+}
+#endif // HKOS_PREEMPTION
+
 /******************************************************************************
  * Called by the HAL to mark the passage of time
  *
@@ -428,25 +1197,79 @@ void hkos_scheduler_switch_context( void ) {
  * ************************************************************************/
 void hkos_scheduler_tick_timer( void ) {
 
+    ++hkos_ram.runtime_data.ticks;
+    HKOS_HOOK_TICK( hkos_ram.runtime_data.ticks );
+
+#if HKOS_PROFILER
+    // The tick timer interrupt has just saved the context of the running task
+    hkos_task_t* p_sampled = hkos_ram.runtime_data.p_running_task;
+    hkos_profiler_sample( p_sampled, p_sampled != NULL ?
+                          hkos_hal_get_saved_pc( p_sampled->p_sp ) : 0 );
+#endif
+
+#if HKOS_TIMERS_ENABLE > 0
+    // Timers go first, so the timer task can be woken up in this same tick
+    hkos_timer_tick();
+#endif
+
     update_blocked();
 
+#if HKOS_PREEMPTION
+#if HKOS_SCHED_PRIORITY
+    // Preempt the running task if a task with a priority higher than its
+    // preemption threshold is ready
+    hkos_task_t* p_head = hkos_ram.runtime_data.p_ready_tasks;
+    hkos_task_t* p_running = hkos_ram.runtime_data.p_running_task;
+    if ( p_head != NULL && p_head != p_running &&
+         ( p_running == NULL || preempts( p_head, p_running ) ) ) {
+        preempt();
+        return;
+    }
+#endif
+
+#if HKOS_SCHED_EDF
+    // Preempt the running task if a task with an earlier deadline is ready
+    hkos_task_t* p_head = hkos_ram.runtime_data.p_ready_tasks;
+    hkos_task_t* p_running = hkos_ram.runtime_data.p_running_task;
+    if ( p_head != NULL && p_head != p_running && p_head->has_deadline &&
+         ( p_running == NULL || preempts( p_head, p_running ) ) ) {
+        preempt();
+        return;
+    }
+#endif
+
     ++hkos_ram.runtime_data.ticks_from_switch;
-    if (  hkos_ram.runtime_data.ticks_from_switch >
-            ( HKOS_HAL_TICKS_IN_A_SECOND * HKOS_TIME_SLICE / 1000 ) ) {
-        hkos_scheduler_switch_context();
+    if ( time_slice_over() ) {
+#if HKOS_SCHED_PRIORITY
+        // A task raised to a threshold above its priority is not sliced,
+        // otherwise a task that is not above the threshold would run. The
+        // other tasks go behind the ready tasks with the same priority.
+        if ( p_running != NULL && p_running->threshold > p_running->priority )
+            return;
+
+        hkos_scheduler_rotate();
+#endif
+        preempt();
     }
+#endif // HKOS_PREEMPTION
 }
 
 /******************************************************************************
  * Yield the execution to another task
  *
  * ************************************************************************/
+#if HKOS_HAL_HAS_YIELD
+void hkos_scheduler_yield( void ) {
+    hkos_hal_yield();
+}
+#else
 __attribute__((naked))
 void hkos_scheduler_yield( void ) {
     hkos_hal_save_context();
     hkos_scheduler_switch_context();
     hkos_hal_restore_context();
 }
+#endif
 
 /******************************************************************************
  * Create a mutex
@@ -456,7 +1279,7 @@ void hkos_scheduler_yield( void ) {
  * ***************************************************************************/
 void* hkos_scheduler_create_mutex( void ) {
 
-    hkos_mutex_t* p_mutex = mem_alloc( sizeof(hkos_mutex_t) );
+    hkos_mutex_t* p_mutex = hkos_scheduler_alloc( sizeof(hkos_mutex_t) );
 
     if ( p_mutex != NULL ) {
         p_mutex->p_task = NULL;
@@ -485,6 +1308,7 @@ void hkos_scheduler_lock_mutex( hkos_mutex_t* p_mutex ) {
 
     if ( p_mutex->locked ) {
         hkos_hal_enter_critical_section();
+        HKOS_HOOK_MUTEX_BLOCK( p_mutex, hkos_ram.runtime_data.p_running_task );
         remove_task_from_ready_list( hkos_ram.runtime_data.p_running_task );
         add_task_to_tail( hkos_ram.runtime_data.p_running_task, &p_mutex->p_task );
         hkos_hal_exit_critical_section();
@@ -495,6 +1319,9 @@ void hkos_scheduler_lock_mutex( hkos_mutex_t* p_mutex ) {
         p_mutex->locked = true;
 
     }
+
+    // the unlocking task hands the mutex over to a waiting task
+    HKOS_HOOK_MUTEX_LOCK( p_mutex );
 }
 
 /******************************************************************************
@@ -507,16 +1334,29 @@ void hkos_scheduler_unlock_mutex( hkos_mutex_t* p_mutex ) {
 
     if ( p_mutex != NULL ) {
 
+        HKOS_HOOK_MUTEX_UNLOCK( p_mutex );
+
         if ( p_mutex->p_task != NULL ) {
             hkos_task_t* released = p_mutex->p_task;
             hkos_hal_enter_critical_section();
             remove_task_from_list( p_mutex->p_task, &p_mutex->p_task );
-            add_task_to_head( released, &hkos_ram.runtime_data.p_ready_tasks );
+            make_ready( released );
             hkos_hal_exit_critical_section();
         }
 
         if ( p_mutex->p_task == NULL )
             p_mutex->locked = false;
+
+#if HKOS_SCHED_PRIORITY && HKOS_PREEMPTION
+        // The released task gets the CPU now if its priority is above the
+        // threshold of the running task
+        hkos_task_t* p_running = hkos_ram.runtime_data.p_running_task;
+        hkos_task_t* p_head = hkos_ram.runtime_data.p_ready_tasks;
+        if ( p_running != NULL && p_head != NULL &&
+             p_head->eff_priority > p_running->eff_priority ) {
+            hkos_scheduler_yield();
+        }
+#endif
     }
 
 }
@@ -530,38 +1370,233 @@ void hkos_scheduler_unlock_mutex( hkos_mutex_t* p_mutex ) {
 void hkos_scheduler_destroy_mutex( hkos_mutex_t* p_mutex ) {
 
     if ( p_mutex != NULL && p_mutex->locked == false ) {
-        mem_free( p_mutex );
+        hkos_scheduler_free( p_mutex );
+    }
+
+}
+
+/******************************************************************************
+ * Suspend the callee for the specified number of ticks
+ *
+ * @param[in]       delay_ticks     The number of ticks to suspend the task or
+ *                                  HKOS_WAIT_FOREVER
+ *
+ * ***************************************************************************/
+void hkos_scheduler_sleep( uint32_t delay_ticks ) {
+
+    hkos_hal_enter_critical_section();
+    // Check the delay ticks. If it has not changed, we put the task to sleep.
+    // Otherwise, an event the task was waiting happened and we need to return
+    // immediately.
+    if ( hkos_ram.runtime_data.p_running_task->delay_ticks == HKOS_DELAY_UNCHANGED )
+    {
+        hkos_ram.runtime_data.p_running_task->delay_ticks = delay_ticks;
+        HKOS_HOOK_TASK_BLOCK( hkos_ram.runtime_data.p_running_task );
+        remove_task_from_ready_list( hkos_ram.runtime_data.p_running_task );
+        add_task_to_head( hkos_ram.runtime_data.p_running_task,
+                            &hkos_ram.runtime_data.p_blocked_tasks );
+    } else {
+        // The event is consumed here. Otherwise, the task would never
+        // block again.
+        hkos_ram.runtime_data.p_running_task->delay_ticks = HKOS_DELAY_UNCHANGED;
     }
+    hkos_hal_exit_critical_section();
+    hkos_scheduler_yield();
+}
+
+/******************************************************************************
+ * Suspend the callee until a release time
+ *
+ * The release time is advanced by one period from its previous value, so
+ * the release times do not drift.
+ *
+ * @param[inout]    p_last_wake     The previous release time. It is updated
+ *                                  to the new release time.
+ * @param[in]       period          The period in ticks
+ *
+ * @return  false if the new release time had already been reached, in which
+ *          case the callee does not sleep.
+ *
+ * ***************************************************************************/
+bool hkos_scheduler_sleep_until( hkos_tick_t* p_last_wake, hkos_tick_t period )
+{
+    *p_last_wake += period;
+
+    hkos_tick_diff_t delay =
+        (hkos_tick_diff_t)( *p_last_wake - hkos_ram.runtime_data.ticks );
+
+    if ( delay <= 0 )
+        return false;
 
+    hkos_scheduler_sleep( (uint32_t)delay );
+    return true;
 }
 
 /******************************************************************************
- * Suspend the callee for the specified time
+ * Get the number of ticks since HalfKOS started
  *
- * @param[in]       time_ms     The time to suspend the task in milliseconds
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @return  The tick counter
  *
  * ***************************************************************************/
-void hkos_scheduler_sleep( uint16_t time_ms ) {
+hkos_tick_t hkos_scheduler_get_ticks( void )
+{
+    return hkos_ram.runtime_data.ticks;
+}
 
-    uint16_t delay_ticks = time_ms * ( 1000 / ( HKOS_HAL_TICKS_IN_A_SECOND ) );
+#if HKOS_SWITCH_COUNTER
+/******************************************************************************
+ * Get the number of context switches since HalfKOS started
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @return  The number of times the running task (or idle) changed
+ *
+ * ***************************************************************************/
+uint32_t hkos_scheduler_get_switches( void )
+{
+    return hkos_ram.runtime_data.switches;
+}
+#endif
 
-    if ( ( time_ms == HKOS_WAIT_FOREVER ) || delay_ticks > 0 ) {
-        hkos_hal_enter_critical_section();
-        // Check the delay ticks. If it has not changed, we put the task to sleep.
-        // Otherwise, an event the task was waiting happened and we need to return
-        // immediately.
-        if ( hkos_ram.runtime_data.p_running_task->delay_ticks == HKOS_DELAY_UNCHANGED )
-        {
-            hkos_ram.runtime_data.p_running_task->delay_ticks = delay_ticks;
-            remove_task_from_ready_list( hkos_ram.runtime_data.p_running_task );
-            add_task_to_head( hkos_ram.runtime_data.p_running_task,
-                                &hkos_ram.runtime_data.p_blocked_tasks );
-        }
-        hkos_hal_exit_critical_section();
-        hkos_scheduler_yield();
+#if HKOS_PAINT_TASK_STACK
+/**************************************************************************
+ * Helper function to count the painted bytes at the bottom of a stack
+ *
+ * @param[in]       p_bottom        The lowest address of the stack
+ * @param[in]       size            The size of the stack
+ *
+ * @return      Number of bytes holding HKOS_STACK_PAINT_VALUE from the bottom
+ *
+ * ************************************************************************/
+static hkos_size_t count_paint( const uint8_t* p_bottom, hkos_size_t size ) {
+    hkos_size_t unused = 0;
+
+    while ( unused < size && p_bottom[unused] == HKOS_STACK_PAINT_VALUE )
+        ++unused;
+
+    return unused;
+}
+
+/******************************************************************************
+ * Get the number of bytes of a task stack that were never used
+ *
+ * The stack grows down, so the painted bytes are counted from the bottom
+ * of the painted region up to the first byte the task has written.
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_task_in       Pointer to the task structure
+ *
+ * @return  Number of bytes still holding HKOS_STACK_PAINT_VALUE
+ *
+ * ***************************************************************************/
+hkos_size_t hkos_scheduler_get_stack_unused( void* p_task_in )
+{
+    hkos_task_t* p_task = (hkos_task_t*)p_task_in;
+    hkos_size_t size = p_task->stack_size + hkos_hal_get_min_stack_size();
+
+    return count_paint( stack_top( p_task ) - size, size );
+}
+
+/******************************************************************************
+ * Get the number of bytes of the os stack that were never used
+ *
+ * @return  Number of bytes still holding HKOS_STACK_PAINT_VALUE
+ *
+ * ***************************************************************************/
+hkos_size_t hkos_scheduler_get_os_stack_unused( void )
+{
+    return count_paint( hkos_ram.os_stack, sizeof(hkos_ram.os_stack) );
+}
+#endif
+
+#if HKOS_TASK_STATS
+/******************************************************************************
+ * Get the statistics of a task
+ *
+ * The running task is charged only when it leaves the CPU, so the time
+ * since it got the CPU is added here.
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_task_in       Pointer to the task structure
+ * @param[out]      p_stats         The statistics of the task
+ *
+ * ***************************************************************************/
+void hkos_scheduler_get_task_stats( void* p_task_in, hkos_task_stats_t* p_stats )
+{
+    hkos_task_t* p_task = (hkos_task_t*)p_task_in;
+
+    *p_stats = p_task->stats;
+
+    if ( p_task == hkos_ram.runtime_data.p_running_task ) {
+        hkos_run_time_t now;
+        get_time( &now );
+        add_time( &p_stats->run_time, &hkos_ram.runtime_data.last_switch, &now );
     }
 }
 
+/******************************************************************************
+ * Get the time the CPU was idle since HalfKOS started
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[out]      p_idle          The idle time
+ *
+ * ***************************************************************************/
+void hkos_scheduler_get_idle_time( hkos_run_time_t* p_idle )
+{
+    *p_idle = hkos_ram.runtime_data.idle_time;
+
+    if ( hkos_ram.runtime_data.p_running_task == NULL ) {
+        hkos_run_time_t now;
+        get_time( &now );
+        add_time( p_idle, &hkos_ram.runtime_data.last_switch, &now );
+    }
+}
+
+/******************************************************************************
+ * Get the CPU load since the previous call
+ *
+ * The window is measured in 1/HKOS_HAL_TICK_FRACTIONS of a tick in 32 bits,
+ * so calls must be closer than 2^32 of those apart.
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @return  Percentage of the time the CPU was not idle
+ *
+ * ***************************************************************************/
+uint8_t hkos_scheduler_get_cpu_load( void )
+{
+    hkos_run_time_t now, idle;
+    hkos_run_time_t window = { 0, 0 };
+    hkos_run_time_t idle_window = { 0, 0 };
+
+    get_time( &now );
+    hkos_scheduler_get_idle_time( &idle );
+
+    add_time( &window, &hkos_ram.runtime_data.load_start, &now );
+    add_time( &idle_window, &hkos_ram.runtime_data.load_idle, &idle );
+
+    hkos_ram.runtime_data.load_start = now;
+    hkos_ram.runtime_data.load_idle = idle;
+
+    uint32_t total = (uint32_t)window.ticks * HKOS_HAL_TICK_FRACTIONS
+                        + window.fraction;
+    uint32_t busy = total - ( (uint32_t)idle_window.ticks * HKOS_HAL_TICK_FRACTIONS
+                                + idle_window.fraction );
+
+    // avoid overflowing busy * 100
+    if ( total < 100 )
+        return ( total == 0 ) ? 0 : (uint8_t)( busy * 100 / total );
+
+    uint32_t load = busy / ( total / 100 );
+    return ( load > 100 ) ? 100 : (uint8_t)load;
+}
+#endif
+
 /******************************************************************************
  * Suspend the callee until the task is signalled
  *
@@ -582,3 +1617,35 @@ void hkos_scheduler_signal( void* pTask )
     // Remove task from the blocked list in the next scheduler execution
     ((hkos_task_t*)pTask)->delay_ticks = 1;
 }
+
+/******************************************************************************
+ * Wake up a suspended task right away
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       Pointer to the task
+ *
+ * @return  true if the task must preempt the running task
+ *
+ * ***************************************************************************/
+bool hkos_scheduler_wake( void* pTask )
+{
+    hkos_task_t* p_task = (hkos_task_t*)pTask;
+
+    // A task that is not blocked yet gets the signal, so it does not block
+    if ( p_task->pp_list != &hkos_ram.runtime_data.p_blocked_tasks ) {
+        p_task->delay_ticks = 1;
+        return false;
+    }
+
+    p_task->delay_ticks = HKOS_DELAY_UNCHANGED;
+    remove_task_from_list( p_task, &hkos_ram.runtime_data.p_blocked_tasks );
+    make_ready( p_task );
+
+#if HKOS_PREEMPTION && ( HKOS_SCHED_PRIORITY || HKOS_SCHED_EDF )
+    hkos_task_t* p_running = hkos_ram.runtime_data.p_running_task;
+    return p_running != NULL && preempts( p_task, p_running );
+#else
+    return false;
+#endif
+}
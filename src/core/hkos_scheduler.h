@@ -22,6 +22,7 @@
 #ifndef __HKOS_SCHEDULER_H
 #define __HKOS_SCHEDULER_H
 
+#include <hkos_core.h>
 #include <hkos_hal.h>
 #include <hkos_config.h>
 
@@ -38,10 +39,60 @@ typedef struct hkos_task_t hkos_task_t; // forward declaration due to pointers
 typedef struct hkos_task_t {
     void*               p_sp;
     hkos_task_t*        p_next;
-    uint16_t            delay_ticks;
+    hkos_task_t**       pp_list;        // head of the list the task is in
+    uint32_t            delay_ticks;
+#if HKOS_SCHED_EDF
+    hkos_tick_t         deadline;       // absolute deadline of the current job
+    bool                has_deadline;
+#endif
+#if HKOS_PER_TASK_TIME_SLICE
+    uint16_t            time_slice;     // in ticks. 0 runs until it blocks
+    uint16_t            preemptions;
+#endif
+#if HKOS_SCHED_PRIORITY
+    uint8_t             priority;
+    uint8_t             threshold;      // preemption threshold
+    uint8_t             eff_priority;   // the ready list is sorted by it
+#endif
+#if HKOS_TASK_STATS
+    hkos_task_stats_t   stats;
+#endif
+#if HKOS_TASK_RESTART
+    void                (*p_entry)();
+    void*               p_arg;
+#endif
+#if HKOS_TASK_RESTART || HKOS_PAINT_TASK_STACK
+    hkos_size_t         stack_size;
+#endif
+#if HKOS_STACK_CHECK
+    uint16_t*           p_canary;       // right below the stack
+#endif
+#if HKOS_PROF_REGIONS > 0 && HKOS_PROF_EXCLUDE_OTHERS
+    uint32_t            prof_cycles;    // cycles on the CPU until last switch
+#endif
 } hkos_task_t;
 
 
+/******************************************************************************
+ * HalfKOS periodic task structure
+ *
+ * A periodic task extends hkos_task_t, so it can be handled as a regular
+ * task by the scheduler.
+ *
+ *****************************************************************************/
+typedef struct hkos_periodic_task_t {
+    hkos_task_t         task;       // must be the first member
+    void                (*p_job)();
+    hkos_tick_t         period;
+    hkos_tick_t         release;    // release time of the current job
+    uint16_t            overruns;
+#if HKOS_SCHED_EDF
+    hkos_tick_t         rel_deadline;
+    uint16_t            deadline_misses;
+#endif
+} hkos_periodic_task_t;
+
+
 /******************************************************************************
  * HalfKOS mutex structure
  *
@@ -66,7 +117,21 @@ typedef struct hkos_runtime_data_t {
     hkos_task_t*        p_ready_tasks;
     hkos_task_t*        p_blocked_tasks;
     void*               p_idle_sp;
+    hkos_task_t*        p_zombie;       // exited task waiting to be freed
+    hkos_tick_t         ticks;
     uint16_t            ticks_from_switch;
+#if HKOS_SWITCH_COUNTER
+    uint32_t            switches;
+#endif
+#if HKOS_TASK_STATS
+    hkos_run_time_t     idle_time;
+    hkos_run_time_t     last_switch;    // when the running task got the CPU
+    hkos_run_time_t     load_start;     // start of the CPU load window
+    hkos_run_time_t     load_idle;      // idle time at the start of the window
+#endif
+#if HKOS_PROF_REGIONS > 0 && HKOS_PROF_EXCLUDE_OTHERS
+    uint32_t            prof_last_switch; // cycle counter at the last switch
+#endif
 } hkos_runtime_data_t;
 
 /******************************************************************************
@@ -85,7 +150,7 @@ typedef struct hkos_runtime_data_t {
  *****************************************************************************/
 typedef struct hkos_ram_t {
     hkos_runtime_data_t     runtime_data;
-    uint8_t                 dynamic_buffer[ HKOS_AVAILABLE_RAM
+    uint8_t                 dynamic_buffer[ HKOS_AVAILABLE_RAM * HKOS_HAL_RAM_SCALE
                                             - HKOS_IDLE_STACK
                                             - sizeof( hkos_runtime_data_t )
                                          ];
@@ -96,7 +161,7 @@ typedef struct hkos_ram_t {
  * The HalfKOS ram structure needs to be accessed for saving and restoring
  * the context, which is done by the tick timer ISR
  *****************************************************************************/
-extern hkos_ram_t hkos_ram;
+extern HKOS_INSTANCE_LOCAL hkos_ram_t hkos_ram;
 
 /******************************************************************************
  * HalfKOS ram memory dynamic allocation block header structure
@@ -136,21 +201,162 @@ typedef struct hkos_ram_block_t {
 void  hkos_scheduler_init( void );
 
 
+/******************************************************************************
+ * Allocate a memory block in the HKOS RAM buffer
+ *
+ * Used by the scheduler and by the other kernel services (timers, mutexes)
+ * to allocate their control blocks.
+ *
+ * ATTENTION: The caller MUST assure there is no concurrent calls to this
+ * function. It is not thread safe by design
+ *
+ * @param[in]   size    size of the block being allocated
+ *
+ * @return Address of the block or NULL
+ *
+ *****************************************************************************/
+void* hkos_scheduler_alloc( hkos_dmem_header_t size );
+
+
+/******************************************************************************
+ * Free a memory block in the HKOS RAM buffer
+ *
+ * ATTENTION: The caller MUST assure there is no concurrent calls to this
+ * function. It is not thread safe by design
+ *
+ * @param[in]   p_mem       pointer to the memory being freed
+ *
+ *****************************************************************************/
+void  hkos_scheduler_free( void* p_mem );
+
+
+/******************************************************************************
+ * Create a task without making it ready
+ *
+ * Used by the kernel services whose tasks extend hkos_task_t. The extended
+ * fields must be initialized before calling hkos_scheduler_start_task.
+ *
+ * @param[in]   p_task_func     Pointer to the task address
+ * @param[in]   p_arg           Argument passed to the task function
+ * @param[in]   stack_size      Size of the task's size
+ * @param[in]   task_size       Size of the task structure, which may extend
+ *                              hkos_task_t
+ *
+ * @return  Pointer to the task structure or NULL if task cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_scheduler_create_task( void (*p_task_func)(),
+                                  void* p_arg,
+                                  hkos_size_t stack_size,
+                                  hkos_size_t task_size );
+
+
+/******************************************************************************
+ * Make a task created by hkos_scheduler_create_task ready
+ *
+ * @param[in]   p_task_in       Pointer to the task structure
+ *
+ *****************************************************************************/
+void  hkos_scheduler_start_task( void* p_task_in );
+
+
 /******************************************************************************
  * Add a task to HalfKOS scheduler
  *
  * @param[in]   p_task_func     Pointer to the task address
+ * @param[in]   p_arg           Argument passed to the task function
  * @param[in]   stack_size      Size of the task's size
  *
  * @return  Pointer to the task structure or NULL if task cannot be created.
  *
  *****************************************************************************/
-void* hkos_scheduler_add_task( void (*p_task_func)(), hkos_size_t stack_size );
+void* hkos_scheduler_add_task( void (*p_task_func)(),
+                               void* p_arg,
+                               hkos_size_t stack_size );
+
+
+/******************************************************************************
+ * Add a periodic task to HalfKOS scheduler
+ *
+ * p_job is called once per period. The first job is released when the
+ * task is added.
+ *
+ * @param[in]   p_job           Function executed once per period
+ * @param[in]   period          Period of the task in ticks
+ * @param[in]   stack_size      Size of the task's size
+ *
+ * @return  Pointer to the task structure or NULL if task cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_scheduler_add_periodic_task( void (*p_job)(),
+                                        hkos_tick_t period,
+                                        hkos_size_t stack_size );
+
+
+#if HKOS_SCHED_EDF
+/******************************************************************************
+ * Set the relative deadline of a periodic task
+ *
+ * The new deadline applies to the current job.
+ *
+ * @param[in]   p_task_in       Pointer to the task structure returned by
+ *                              hkos_scheduler_add_periodic_task
+ * @param[in]   deadline        Deadline in ticks relative to each release
+ *
+ *****************************************************************************/
+void  hkos_scheduler_set_deadline( void* p_task_in, hkos_tick_t deadline );
+#endif
+
+
+#if HKOS_PER_TASK_TIME_SLICE
+/******************************************************************************
+ * Set the time slice of a task
+ *
+ * @param[in]   p_task_in       Pointer to the task structure
+ * @param[in]   time_slice      Time slice in ticks. 0 makes the task run
+ *                              until it blocks
+ *
+ *****************************************************************************/
+void  hkos_scheduler_set_time_slice( void* p_task_in, uint16_t time_slice );
+#endif
+
+
+#if HKOS_SCHED_PRIORITY
+/******************************************************************************
+ * Set the priority and the preemption threshold of a task
+ *
+ * @param[in]   p_task_in       Pointer to the task structure
+ * @param[in]   priority        Priority of the task. Higher runs first
+ * @param[in]   threshold       Preemption threshold. It is raised to the
+ *                              priority if lower
+ *
+ *****************************************************************************/
+void  hkos_scheduler_set_priority( void* p_task_in,
+                                   uint8_t priority,
+                                   uint8_t threshold );
+
+
+/******************************************************************************
+ * Move the running task behind the ready tasks with its effective priority
+ *
+ * Called before the running task yields and when its time slice is over,
+ * so the tasks with the same effective priority share the CPU in
+ * round-robin.
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ *****************************************************************************/
+void  hkos_scheduler_rotate( void );
+#endif
 
 
 /******************************************************************************
  * Remove a task from HalfKOS scheduler
  *
+ * The task is taken out of whatever list it is in and its memory is freed.
+ * A task removing itself never returns from this call and its memory is
+ * freed in the next context switch, when it is no longer using its stack.
+ *
  * @param[in]   p_task_in       Pointer to the task structure returned by
  *                              hkos_add_task
  *
@@ -158,6 +364,33 @@ void* hkos_scheduler_add_task( void (*p_task_func)(), hkos_size_t stack_size );
 void  hkos_scheduler_remove_task( void* p_task_in );
 
 
+#if HKOS_TASK_RESTART
+/******************************************************************************
+ * Restart a task in its own memory block
+ *
+ * The task is taken out of whatever list it is in, its stack is initialized
+ * again and it is made ready. No memory is allocated.
+ *
+ * @param[in]   p_task_in       Pointer to the task structure returned by
+ *                              hkos_add_task
+ *
+ * @return  false if the task is the running one and cannot be restarted
+ *
+ *****************************************************************************/
+bool  hkos_scheduler_restart_task( void* p_task_in );
+#endif
+
+
+/******************************************************************************
+ * Remove the running task from HalfKOS scheduler
+ *
+ * The HAL makes this function the return address of every task, so a task
+ * function that returns is removed.
+ *
+ *****************************************************************************/
+void  hkos_scheduler_exit_task( void );
+
+
 /******************************************************************************
  * Execute a context switch
  *
@@ -165,6 +398,17 @@ void  hkos_scheduler_remove_task( void* p_task_in );
 void  hkos_scheduler_switch_context( void );
 
 
+/******************************************************************************
+ * Yield the execution to another task
+ *
+ *****************************************************************************/
+#if HKOS_HAL_HAS_YIELD
+void  hkos_scheduler_yield( void );
+#else
+void  hkos_scheduler_yield( void ) __attribute__((naked));
+#endif
+
+
 /******************************************************************************
  * Called by the HAL to mark the passage of time
  *
@@ -212,12 +456,111 @@ void hkos_scheduler_destroy_mutex( hkos_mutex_t* p_mutex );
 
 
 /******************************************************************************
- * Suspend the callee for the specified time
+ * Suspend the callee for the specified number of ticks
+ *
+ * @param[in]       delay_ticks     The number of ticks to suspend the task or
+ *                                  HKOS_WAIT_FOREVER
+ *
+ * ***************************************************************************/
+void hkos_scheduler_sleep( uint32_t delay_ticks );
+
+
+/******************************************************************************
+ * Suspend the callee until a release time
+ *
+ * @param[inout]    p_last_wake     The previous release time. It is updated
+ *                                  to the new release time.
+ * @param[in]       period          The period in ticks
+ *
+ * @return  false if the new release time had already been reached, in which
+ *          case the callee does not sleep.
+ *
+ * ***************************************************************************/
+bool hkos_scheduler_sleep_until( hkos_tick_t* p_last_wake, hkos_tick_t period );
+
+
+/******************************************************************************
+ * Get the number of ticks since HalfKOS started
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @return  The tick counter
+ *
+ * ***************************************************************************/
+hkos_tick_t hkos_scheduler_get_ticks( void );
+
+
+#if HKOS_SWITCH_COUNTER
+/******************************************************************************
+ * Get the number of context switches since HalfKOS started
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @return  The number of times the running task (or idle) changed
+ *
+ * ***************************************************************************/
+uint32_t hkos_scheduler_get_switches( void );
+#endif
+
+
+#if HKOS_PAINT_TASK_STACK
+/******************************************************************************
+ * Get the number of bytes of a task stack that were never used
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_task_in       Pointer to the task structure
  *
- * @param[in]       time_ms     The time to suspend the task in milliseconds
+ * @return  Number of bytes still holding HKOS_STACK_PAINT_VALUE
  *
  * ***************************************************************************/
-void hkos_scheduler_sleep( uint16_t time_ms );
+hkos_size_t hkos_scheduler_get_stack_unused( void* p_task_in );
+
+
+/******************************************************************************
+ * Get the number of bytes of the os stack that were never used
+ *
+ * @return  Number of bytes still holding HKOS_STACK_PAINT_VALUE
+ *
+ * ***************************************************************************/
+hkos_size_t hkos_scheduler_get_os_stack_unused( void );
+#endif
+
+
+#if HKOS_TASK_STATS
+/******************************************************************************
+ * Get the statistics of a task
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_task_in       Pointer to the task structure
+ * @param[out]      p_stats         The statistics of the task
+ *
+ * ***************************************************************************/
+void hkos_scheduler_get_task_stats( void* p_task_in, hkos_task_stats_t* p_stats );
+
+
+/******************************************************************************
+ * Get the time the CPU was idle since HalfKOS started
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[out]      p_idle          The idle time
+ *
+ * ***************************************************************************/
+void hkos_scheduler_get_idle_time( hkos_run_time_t* p_idle );
+
+
+/******************************************************************************
+ * Get the CPU load since the previous call
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @return  Percentage of the time the CPU was not idle
+ *
+ * ***************************************************************************/
+uint8_t hkos_scheduler_get_cpu_load( void );
+#endif
 
 
 /******************************************************************************
@@ -235,4 +578,24 @@ void hkos_scheduler_suspend( void );
  * ***************************************************************************/
 void hkos_scheduler_signal( void* pTask );
 
+
+/******************************************************************************
+ * Wake up a suspended task right away
+ *
+ * Unlike hkos_scheduler_signal, the task goes to the ready list now, not at
+ * the next tick. If the task is not suspended, its next suspend returns at
+ * once, as with hkos_scheduler_signal. It can be called from ISRs.
+ *
+ * The caller must yield when it returns true, unless it runs in an ISR, in
+ * which case the task waits for the next context switch.
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       Pointer to the task
+ *
+ * @return  true if the task must preempt the running task
+ *
+ * ***************************************************************************/
+bool hkos_scheduler_wake( void* pTask );
+
 #endif // __HKOS_SCHEDULER_H
@@ -0,0 +1,256 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+#include <stddef.h>
+#include <hkos_hal.h>
+#include <hkos_scheduler.h>
+#include <hkos_timer.h>
+#include <hkos_timer_queue.h>
+
+// Software timers are only available when enabled in hkos_config.h
+#if HKOS_TIMERS_ENABLE > 0
+
+// Timer states
+#define TIMER_IDLE                  0
+#define TIMER_ACTIVE                1   // in the timer queue
+#define TIMER_EXPIRED               2   // waiting for the timer task
+
+/******************************************************************************
+ * Timer service runtime data
+ *
+ *****************************************************************************/
+typedef struct hkos_timer_data_t {
+    hkos_timer_t*       p_expired;      // waiting for the callbacks to run
+    hkos_task_t*        p_task;         // timer task
+} hkos_timer_data_t;
+
+static HKOS_INSTANCE_LOCAL hkos_timer_data_t timer_data;
+
+/**************************************************************************
+ * Helper function to take a timer out of whatever list it is in
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_timer         The timer to be detached
+ *
+ * ************************************************************************/
+static void detach_timer( hkos_timer_t* p_timer ) {
+
+    if ( p_timer->state == TIMER_ACTIVE ) {
+        hkos_timer_queue_remove( p_timer );
+    } else if ( p_timer->state == TIMER_EXPIRED ) {
+        hkos_timer_t** pp_pos = &timer_data.p_expired;
+        for (; *pp_pos != NULL; pp_pos = &(*pp_pos)->p_next ) {
+            if ( *pp_pos == p_timer ) {
+                *pp_pos = p_timer->p_next;
+                break;
+            }
+        }
+        p_timer->p_next = NULL;
+    }
+
+    p_timer->state = TIMER_IDLE;
+}
+
+/**************************************************************************
+ * Helper function to put a timer in the timer queue
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       p_timer         The timer to be queued
+ *
+ * ************************************************************************/
+static void queue_timer( hkos_timer_t* p_timer ) {
+    hkos_timer_queue_insert( p_timer, hkos_scheduler_get_ticks() );
+    p_timer->state = TIMER_ACTIVE;
+}
+
+/**************************************************************************
+ * Timer task
+ *
+ * Runs the callbacks of the expired timers and goes back to sleep until
+ * the tick timer signals it again.
+ *
+ * ************************************************************************/
+static void timer_task( void ) {
+
+    while( 1 ) {
+        hkos_hal_enter_critical_section();
+
+        hkos_timer_t* p_timer;
+        while ( ( p_timer = timer_data.p_expired ) != NULL ) {
+
+            timer_data.p_expired = p_timer->p_next;
+
+            if ( p_timer->mode == HKOS_TIMER_AUTO_RELOAD ) {
+                // next expiry is computed from the previous one, not from
+                // now, so the timer does not drift
+                p_timer->expiry += p_timer->period;
+                queue_timer( p_timer );
+            } else {
+                p_timer->p_next = NULL;
+                p_timer->state = TIMER_IDLE;
+            }
+
+            // the callback may stop or destroy the timer, so we don't touch
+            // it after the call
+            hkos_timer_callback_t p_callback = p_timer->p_callback;
+            void* p_arg = p_timer->p_arg;
+
+            hkos_hal_exit_critical_section();
+            p_callback( p_arg );
+            hkos_hal_enter_critical_section();
+        }
+
+        hkos_hal_exit_critical_section();
+
+        hkos_scheduler_suspend();
+    }
+}
+
+/******************************************************************************
+ * Initialize the timer service
+ *
+ * Creates the timer task. Called by hkos_init.
+ *
+ *****************************************************************************/
+void hkos_timer_init( void ) {
+    hkos_timer_queue_init();
+    timer_data.p_expired = NULL;
+    timer_data.p_task = hkos_scheduler_add_task( timer_task, NULL, HKOS_TIMER_TASK_STACK );
+}
+
+/******************************************************************************
+ * Create a software timer
+ *
+ * @param[in]   period_ms       Timer period in milliseconds
+ * @param[in]   mode            HKOS_TIMER_ONE_SHOT or HKOS_TIMER_AUTO_RELOAD
+ * @param[in]   p_callback      Function called when the timer expires
+ * @param[in]   p_arg           Argument passed to the callback
+ *
+ * @return  Pointer to the timer structure or NULL if it cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_timer_create( uint32_t period_ms,
+                         hkos_timer_mode_t mode,
+                         hkos_timer_callback_t p_callback,
+                         void* p_arg )
+{
+    if ( p_callback == NULL || timer_data.p_task == NULL )
+        return NULL;
+
+    hkos_hal_enter_critical_section();
+    hkos_timer_t* p_timer = hkos_scheduler_alloc( sizeof(hkos_timer_t) );
+    hkos_hal_exit_critical_section();
+
+    if ( p_timer != NULL ) {
+        hkos_tick_t period = HKOS_MS_TO_TICKS( period_ms );
+
+        p_timer->p_next = NULL;
+        p_timer->p_callback = p_callback;
+        p_timer->p_arg = p_arg;
+        p_timer->period = ( period > 0 ) ? period : 1;
+        p_timer->mode = mode;
+        p_timer->state = TIMER_IDLE;
+    }
+
+    return p_timer;
+}
+
+/******************************************************************************
+ * Start or restart a timer
+ *
+ * @param[in]   p_timer     Pointer to the timer
+ *
+ *****************************************************************************/
+void hkos_timer_start( void* p_timer_in ) {
+
+    if ( p_timer_in != NULL ) {
+        hkos_timer_t* p_timer = (hkos_timer_t*)p_timer_in;
+
+        hkos_hal_enter_critical_section();
+        detach_timer( p_timer );
+        p_timer->expiry = hkos_scheduler_get_ticks() + p_timer->period;
+        queue_timer( p_timer );
+        hkos_hal_exit_critical_section();
+    }
+}
+
+/******************************************************************************
+ * Stop a timer
+ *
+ * @param[in]   p_timer     Pointer to the timer
+ *
+ *****************************************************************************/
+void hkos_timer_stop( void* p_timer ) {
+
+    if ( p_timer != NULL ) {
+        hkos_hal_enter_critical_section();
+        detach_timer( (hkos_timer_t*)p_timer );
+        hkos_hal_exit_critical_section();
+    }
+}
+
+/******************************************************************************
+ * Destroy a timer
+ *
+ * @param[in]   p_timer     Pointer to the timer
+ *
+ *****************************************************************************/
+void hkos_timer_destroy( void* p_timer ) {
+
+    if ( p_timer != NULL ) {
+        hkos_hal_enter_critical_section();
+        detach_timer( (hkos_timer_t*)p_timer );
+        hkos_scheduler_free( p_timer );
+        hkos_hal_exit_critical_section();
+    }
+}
+
+/******************************************************************************
+ * Called by the scheduler to mark the passage of time
+ *
+ * The scheduler increments the tick counter before calling this function.
+ * Caller is responsible for making sure this will not be preempted
+ *
+ *****************************************************************************/
+void hkos_timer_tick( void ) {
+
+    hkos_timer_t* p_first = hkos_timer_queue_expire( hkos_scheduler_get_ticks() );
+
+    // most of the ticks end here
+    if ( p_first == NULL )
+        return;
+
+    // hand the expired timers over to the timer task
+    hkos_timer_t** pp_tail = &timer_data.p_expired;
+    while ( *pp_tail != NULL )
+        pp_tail = &(*pp_tail)->p_next;
+    *pp_tail = p_first;
+
+    for (; p_first != NULL; p_first = p_first->p_next )
+        p_first->state = TIMER_EXPIRED;
+
+    hkos_scheduler_signal( timer_data.p_task );
+}
+
+#endif // HKOS_TIMERS_ENABLE > 0
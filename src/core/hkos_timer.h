@@ -0,0 +1,171 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+#ifndef __HKOS_TIMER_H
+#define __HKOS_TIMER_H
+
+#include <hkos_core.h>
+#include <hkos_config.h>
+
+// If HKOS_TIMERS_ENABLE is not defined in hkos_config.h, define it as 0
+#ifndef HKOS_TIMERS_ENABLE
+#define HKOS_TIMERS_ENABLE              0
+#endif
+
+// Software timers are only available when enabled in hkos_config.h
+#if HKOS_TIMERS_ENABLE > 0
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+// Stack of the timer task. All timer callbacks run on this stack.
+#ifndef HKOS_TIMER_TASK_STACK
+#define HKOS_TIMER_TASK_STACK           32
+#endif
+
+// Timer queue backends
+//
+// HKOS_TIMER_QUEUE_LIST keeps the timers in a sorted list. It has the
+// smallest footprint, but starting a timer costs O(n).
+//
+// HKOS_TIMER_QUEUE_WHEEL keeps the timers in a hierarchical timing wheel
+// with O(1) start, stop and tick. Each level of the wheel has
+// 2^HKOS_TIMER_WHEEL_BITS slots of one pointer each, so it is meant for
+// host builds and large RAM parts with lots of timers.
+#define HKOS_TIMER_QUEUE_LIST           0
+#define HKOS_TIMER_QUEUE_WHEEL          1
+
+#ifndef HKOS_TIMER_QUEUE
+#define HKOS_TIMER_QUEUE                HKOS_TIMER_QUEUE_LIST
+#endif
+
+#ifndef HKOS_TIMER_WHEEL_BITS
+#define HKOS_TIMER_WHEEL_BITS           4
+#endif
+
+// Timer modes
+typedef enum {
+    HKOS_TIMER_ONE_SHOT,
+    HKOS_TIMER_AUTO_RELOAD
+} hkos_timer_mode_t;
+
+// Timer callback. It runs in the context of the timer task.
+typedef void (*hkos_timer_callback_t)( void* p_arg );
+
+/******************************************************************************
+ * HalfKOS timer structure
+ *
+ * Timers are kept in a timer queue (see HKOS_TIMER_QUEUE), so the tick
+ * timer never needs to walk all the timers. The expiration is stored as an
+ * absolute value of the HalfKOS tick counter and compared in a wrap safe way,
+ * so auto reload timers do not drift.
+ *
+ *****************************************************************************/
+typedef struct hkos_timer_t hkos_timer_t; // forward declaration due to pointers
+typedef struct hkos_timer_t {
+    hkos_timer_t*           p_next;
+#if HKOS_TIMER_QUEUE == HKOS_TIMER_QUEUE_WHEEL
+    hkos_timer_t**          pp_prev;    // link pointing to this timer
+#endif
+    hkos_timer_callback_t   p_callback;
+    void*                   p_arg;
+    hkos_tick_t             expiry;
+    hkos_tick_t             period;
+    uint8_t                 mode  : 1;
+    uint8_t                 state : 2;
+} hkos_timer_t;
+
+
+/******************************************************************************
+ * Create a software timer
+ *
+ * The timer is created stopped. Call hkos_timer_start to start it.
+ *
+ * Periods are rounded up to the next tick and must be shorter than half the
+ * range of hkos_tick_t.
+ *
+ * @param[in]   period_ms       Timer period in milliseconds
+ * @param[in]   mode            HKOS_TIMER_ONE_SHOT or HKOS_TIMER_AUTO_RELOAD
+ * @param[in]   p_callback      Function called when the timer expires
+ * @param[in]   p_arg           Argument passed to the callback
+ *
+ * @return  Pointer to the timer structure or NULL if it cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_timer_create( uint32_t period_ms,
+                         hkos_timer_mode_t mode,
+                         hkos_timer_callback_t p_callback,
+                         void* p_arg );
+
+
+/******************************************************************************
+ * Start or restart a timer
+ *
+ * The timer expires one period after this call.
+ *
+ * @param[in]   p_timer     Pointer to the timer
+ *
+ *****************************************************************************/
+void hkos_timer_start( void* p_timer );
+
+
+/******************************************************************************
+ * Stop a timer
+ *
+ * @param[in]   p_timer     Pointer to the timer
+ *
+ *****************************************************************************/
+void hkos_timer_stop( void* p_timer );
+
+
+/******************************************************************************
+ * Destroy a timer
+ *
+ * The timer is stopped and its memory is freed. A timer may destroy itself
+ * from its own callback.
+ *
+ * @param[in]   p_timer     Pointer to the timer
+ *
+ *****************************************************************************/
+void hkos_timer_destroy( void* p_timer );
+
+
+/******************************************************************************
+ * Initialize the timer service
+ *
+ * Creates the timer task. Called by hkos_init.
+ *
+ *****************************************************************************/
+void hkos_timer_init( void );
+
+
+/******************************************************************************
+ * Called by the scheduler to mark the passage of time
+ *
+ * The cost of a tick does not depend on the number of timers, whatever
+ * timer queue is selected.
+ *
+ *****************************************************************************/
+void hkos_timer_tick( void );
+
+#endif // HKOS_TIMERS_ENABLE > 0
+
+#endif //__HKOS_TIMER_H
@@ -0,0 +1,118 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/**************************************************************************
+ *
+ * Sorted list timer queue
+ *
+ * The timers are kept in a singly linked list sorted by expiry. Only the
+ * head of the list is checked at each tick.
+ *
+ * ************************************************************************/
+#include <stddef.h>
+#include <hkos_timer_queue.h>
+
+#if ( HKOS_TIMERS_ENABLE > 0 ) && ( HKOS_TIMER_QUEUE == HKOS_TIMER_QUEUE_LIST )
+
+// Head of the list
+static HKOS_INSTANCE_LOCAL hkos_timer_t* p_timers;
+
+/******************************************************************************
+ * Initialize the timer queue
+ *
+ *****************************************************************************/
+void hkos_timer_queue_init( void ) {
+    p_timers = NULL;
+}
+
+/******************************************************************************
+ * Insert a timer in the queue
+ *
+ * Timers expiring at the same tick are kept in the order they were inserted.
+ * A timer whose expiry has been reached goes to the head of the list.
+ *
+ * @param[in]   p_timer     The timer to be inserted
+ * @param[in]   now         The current value of the tick counter
+ *
+ *****************************************************************************/
+void hkos_timer_queue_insert( hkos_timer_t* p_timer, hkos_tick_t now ) {
+
+    hkos_timer_t** pp_pos = &p_timers;
+
+    while ( *pp_pos != NULL &&
+            hkos_tick_reached( p_timer->expiry, (*pp_pos)->expiry ) ) {
+        pp_pos = &(*pp_pos)->p_next;
+    }
+
+    p_timer->p_next = *pp_pos;
+    *pp_pos = p_timer;
+}
+
+/******************************************************************************
+ * Remove a timer from the queue
+ *
+ * @param[in]   p_timer     The timer to be removed
+ *
+ *****************************************************************************/
+void hkos_timer_queue_remove( hkos_timer_t* p_timer ) {
+
+    hkos_timer_t** pp_pos = &p_timers;
+
+    for (; *pp_pos != NULL; pp_pos = &(*pp_pos)->p_next ) {
+        if ( *pp_pos == p_timer ) {
+            *pp_pos = p_timer->p_next;
+            p_timer->p_next = NULL;
+            break;
+        }
+    }
+}
+
+/******************************************************************************
+ * Take the timers expiring at the current tick out of the queue
+ *
+ * @param[in]   now         The current value of the tick counter
+ *
+ * @return  List of expired timers linked by p_next or NULL
+ *
+ *****************************************************************************/
+hkos_timer_t* hkos_timer_queue_expire( hkos_tick_t now ) {
+
+    hkos_timer_t* p_first = p_timers;
+
+    // most of the ticks end here
+    if ( p_first == NULL || !hkos_tick_reached( now, p_first->expiry ) )
+        return NULL;
+
+    // the expired timers are all at the head of the list
+    hkos_timer_t* p_last = p_first;
+    while ( p_last->p_next != NULL &&
+            hkos_tick_reached( now, p_last->p_next->expiry ) ) {
+        p_last = p_last->p_next;
+    }
+
+    p_timers = p_last->p_next;
+    p_last->p_next = NULL;
+
+    return p_first;
+}
+
+#endif // ( HKOS_TIMERS_ENABLE > 0 ) && ( HKOS_TIMER_QUEUE == HKOS_TIMER_QUEUE_LIST )
@@ -0,0 +1,85 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *
+ * Timer queue interface
+ *
+ * The timer service keeps the started timers in a timer queue. There is one
+ * implementation of this interface for each HKOS_TIMER_QUEUE option and only
+ * the selected one is compiled.
+ *
+ * All the functions must be called with the timer service protected against
+ * preemption.
+ *
+ *****************************************************************************/
+#ifndef __HKOS_TIMER_QUEUE_H
+#define __HKOS_TIMER_QUEUE_H
+
+#include <hkos_timer.h>
+
+#if HKOS_TIMERS_ENABLE > 0
+
+/******************************************************************************
+ * Initialize the timer queue
+ *
+ *****************************************************************************/
+void hkos_timer_queue_init( void );
+
+
+/******************************************************************************
+ * Insert a timer in the queue
+ *
+ * The timer must not be in the queue. If its expiry has already been
+ * reached, the timer expires in the next tick.
+ *
+ * @param[in]   p_timer     The timer to be inserted
+ * @param[in]   now         The current value of the tick counter
+ *
+ *****************************************************************************/
+void hkos_timer_queue_insert( hkos_timer_t* p_timer, hkos_tick_t now );
+
+
+/******************************************************************************
+ * Remove a timer from the queue
+ *
+ * @param[in]   p_timer     The timer to be removed
+ *
+ *****************************************************************************/
+void hkos_timer_queue_remove( hkos_timer_t* p_timer );
+
+
+/******************************************************************************
+ * Take the timers expiring at the current tick out of the queue
+ *
+ * Must be called once for every tick.
+ *
+ * @param[in]   now         The current value of the tick counter
+ *
+ * @return  List of expired timers linked by p_next or NULL
+ *
+ *****************************************************************************/
+hkos_timer_t* hkos_timer_queue_expire( hkos_tick_t now );
+
+#endif // HKOS_TIMERS_ENABLE > 0
+
+#endif //__HKOS_TIMER_QUEUE_H
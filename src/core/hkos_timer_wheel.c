@@ -0,0 +1,183 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/**************************************************************************
+ *
+ * Hierarchical timing wheel timer queue
+ *
+ * Each level of the wheel has WHEEL_SLOTS slots and covers
+ * HKOS_TIMER_WHEEL_BITS bits of the tick counter. A timer is stored in
+ * the lowest level in which its expiry and the current tick differ, using
+ * the bits of that level as the slot index. So, the level 0 slot of the
+ * current tick holds exactly the timers expiring now.
+ *
+ * Whenever the bits of a level wrap to zero, the current slot of the level
+ * above is cascaded, i.e., its timers are inserted again and move to the
+ * lower levels. Each timer is cascaded at most once per level, so start,
+ * stop and tick are O(1).
+ *
+ * ************************************************************************/
+#include <stddef.h>
+#include <hkos_timer_queue.h>
+
+#if ( HKOS_TIMERS_ENABLE > 0 ) && ( HKOS_TIMER_QUEUE == HKOS_TIMER_QUEUE_WHEEL )
+
+// Wheel geometry
+#define WHEEL_TICK_BITS         ( 8 * sizeof( hkos_tick_t ) )
+#define WHEEL_SLOTS             ( 1 << HKOS_TIMER_WHEEL_BITS )
+#define WHEEL_MASK              ( WHEEL_SLOTS - 1 )
+#define WHEEL_LEVELS            ( ( WHEEL_TICK_BITS + HKOS_TIMER_WHEEL_BITS - 1 ) \
+                                    / HKOS_TIMER_WHEEL_BITS )
+
+// Slot index of a tick in a level
+#define wheel_slot(tick, level) ( ( (tick) >> ( (level) * HKOS_TIMER_WHEEL_BITS ) ) \
+                                    & WHEEL_MASK )
+
+// The wheel
+static HKOS_INSTANCE_LOCAL hkos_timer_t* wheel[ WHEEL_LEVELS ][ WHEEL_SLOTS ];
+
+/**************************************************************************
+ * Helper function to add a timer to the head of a slot
+ *
+ * @param[in]       p_timer         The timer to be added
+ * @param[inout]    pp_slot         The slot the timer is being added to
+ *
+ * ************************************************************************/
+static void add_timer_to_slot( hkos_timer_t* p_timer, hkos_timer_t** pp_slot ) {
+
+    p_timer->p_next = *pp_slot;
+    if ( p_timer->p_next != NULL )
+        p_timer->p_next->pp_prev = &p_timer->p_next;
+
+    p_timer->pp_prev = pp_slot;
+    *pp_slot = p_timer;
+}
+
+/**************************************************************************
+ * Helper function to add a timer to the wheel
+ *
+ * The expiry of the timer must not be before now.
+ *
+ * @param[in]       p_timer         The timer to be added
+ * @param[in]       now             The current value of the tick counter
+ *
+ * ************************************************************************/
+static void add_timer_to_wheel( hkos_timer_t* p_timer, hkos_tick_t now ) {
+
+    hkos_tick_t diff = p_timer->expiry ^ now;
+    uint8_t level = 0;
+
+    while ( diff >= WHEEL_SLOTS ) {
+        diff >>= HKOS_TIMER_WHEEL_BITS;
+        ++level;
+    }
+
+    add_timer_to_slot( p_timer, &wheel[level][ wheel_slot( p_timer->expiry, level ) ] );
+}
+
+/******************************************************************************
+ * Initialize the timer queue
+ *
+ *****************************************************************************/
+void hkos_timer_queue_init( void ) {
+    for ( uint8_t level = 0; level < WHEEL_LEVELS; ++level ) {
+        for ( uint8_t slot = 0; slot < WHEEL_SLOTS; ++slot ) {
+            wheel[level][slot] = NULL;
+        }
+    }
+}
+
+/******************************************************************************
+ * Insert a timer in the queue
+ *
+ * The current tick has already been handled, so a timer whose expiry has
+ * been reached goes to the level 0 slot of the next tick.
+ *
+ * @param[in]   p_timer     The timer to be inserted
+ * @param[in]   now         The current value of the tick counter
+ *
+ *****************************************************************************/
+void hkos_timer_queue_insert( hkos_timer_t* p_timer, hkos_tick_t now ) {
+
+    if ( hkos_tick_reached( now, p_timer->expiry ) ) {
+        add_timer_to_slot( p_timer, &wheel[0][ wheel_slot( now + 1, 0 ) ] );
+    } else {
+        add_timer_to_wheel( p_timer, now );
+    }
+}
+
+/******************************************************************************
+ * Remove a timer from the queue
+ *
+ * @param[in]   p_timer     The timer to be removed
+ *
+ *****************************************************************************/
+void hkos_timer_queue_remove( hkos_timer_t* p_timer ) {
+
+    *p_timer->pp_prev = p_timer->p_next;
+    if ( p_timer->p_next != NULL )
+        p_timer->p_next->pp_prev = p_timer->pp_prev;
+
+    p_timer->p_next = NULL;
+    p_timer->pp_prev = NULL;
+}
+
+/******************************************************************************
+ * Take the timers expiring at the current tick out of the queue
+ *
+ * @param[in]   now         The current value of the tick counter
+ *
+ * @return  List of expired timers linked by p_next or NULL
+ *
+ *****************************************************************************/
+hkos_timer_t* hkos_timer_queue_expire( hkos_tick_t now ) {
+
+    // Find the highest level whose lower bits wrapped in this tick.
+    uint8_t level = 0;
+    while ( ( level + 1 < WHEEL_LEVELS ) &&
+            ( wheel_slot( now, level ) == 0 ) ) {
+        ++level;
+    }
+
+    // Cascade from the top, so timers moving down to a level are still
+    // cascaded if they land in its current slot.
+    for (; level > 0; --level ) {
+        hkos_timer_t** pp_slot = &wheel[level][ wheel_slot( now, level ) ];
+        hkos_timer_t* p_timer = *pp_slot;
+        *pp_slot = NULL;
+
+        while ( p_timer != NULL ) {
+            hkos_timer_t* p_next = p_timer->p_next;
+            add_timer_to_wheel( p_timer, now );
+            p_timer = p_next;
+        }
+    }
+
+    // Everything in the current level 0 slot expires now
+    hkos_timer_t** pp_slot = &wheel[0][ wheel_slot( now, 0 ) ];
+    hkos_timer_t* p_expired = *pp_slot;
+    *pp_slot = NULL;
+
+    return p_expired;
+}
+
+#endif // ( HKOS_TIMERS_ENABLE > 0 ) && ( HKOS_TIMER_QUEUE == HKOS_TIMER_QUEUE_WHEEL )
@@ -0,0 +1,214 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+#include <hkos_hal.h>
+#include <hkos_scheduler.h>
+#include <hkos_trace.h>
+#include <core/peripherals/serial/hkos_serial_hal.h>
+
+// The trace is only available when enabled in hkos_config.h
+#if HKOS_TRACE
+
+// Number of ticks for the timestamp to wrap around
+#define TRACE_WRAP_TICKS            ( 0x10000UL / HKOS_HAL_TICK_FRACTIONS )
+
+/******************************************************************************
+ * Trace runtime data
+ *
+ *****************************************************************************/
+typedef struct hkos_trace_data_t {
+#if HKOS_TRACE_STREAM
+    uint16_t                lost;           // not reported yet
+#else
+    hkos_trace_record_t     buffer[ HKOS_TRACE_BUFFER ];
+    uint16_t                head;           // next record to be written
+    uint16_t                count;          // records in the buffer
+#endif
+    uint16_t                dropped;
+    hkos_tick_t             last_ticks;     // tick of the previous record
+} hkos_trace_data_t;
+
+static HKOS_INSTANCE_LOCAL hkos_trace_data_t trace_data;
+
+#if HKOS_TRACE_STREAM
+/**************************************************************************
+ * Helper function to write a record to the serial port
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       timestamp       The timestamp
+ * @param[in]       event           The event
+ * @param[in]       arg             The argument of the event
+ *
+ * @return  false if there is no space for the frame in the tx buffer
+ *
+ * ************************************************************************/
+static bool put_record( uint16_t timestamp, uint8_t event, uint16_t arg ) {
+
+    char frame[ HKOS_TRACE_FRAME_SIZE ];
+    frame[0] = (char)( HKOS_TRACE_FRAME_MARKER | event );
+    frame[1] = (char)( timestamp & 0xFF );
+    frame[2] = (char)( timestamp >> 8 );
+    frame[3] = (char)( arg & 0xFF );
+    frame[4] = (char)( arg >> 8 );
+    frame[5] = frame[0] ^ frame[1] ^ frame[2] ^ frame[3] ^ frame[4];
+
+    return hkos_serial_try_write_buffer( HKOS_TRACE_STREAM_PORT, frame,
+                                         HKOS_TRACE_FRAME_SIZE ) == HKOS_ERROR_NONE;
+}
+#else
+/**************************************************************************
+ * Helper function to write a record in the trace buffer
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       timestamp       The timestamp
+ * @param[in]       event           The event
+ * @param[in]       arg             The argument of the event
+ *
+ * @return  Always true. The oldest record is dropped if the buffer is full.
+ *
+ * ************************************************************************/
+static bool put_record( uint16_t timestamp, uint8_t event, uint16_t arg ) {
+
+    hkos_trace_record_t* p_record = &trace_data.buffer[ trace_data.head ];
+    p_record->timestamp = timestamp;
+    p_record->event = event;
+    p_record->arg = arg;
+
+    trace_data.head = ( trace_data.head + 1 ) % HKOS_TRACE_BUFFER;
+
+    if ( trace_data.count < HKOS_TRACE_BUFFER ) {
+        ++trace_data.count;
+    } else {
+        ++trace_data.dropped;
+    }
+
+    return true;
+}
+#endif
+
+/******************************************************************************
+ * Initialize the trace
+ *
+ *****************************************************************************/
+void hkos_trace_init( void ) {
+#if HKOS_TRACE_STREAM
+    trace_data.lost = 0;
+#else
+    trace_data.head = 0;
+    trace_data.count = 0;
+#endif
+    trace_data.dropped = 0;
+    trace_data.last_ticks = 0;
+}
+
+/******************************************************************************
+ * Record an event in the trace buffer
+ *
+ * Interrupts are disabled only while the record is written, so tasks and
+ * ISRs can record events without any lock.
+ *
+ * @param[in]   event       The event
+ * @param[in]   arg         The argument of the event
+ *
+ *****************************************************************************/
+void hkos_trace_event( hkos_trace_event_t event, uint16_t arg ) {
+
+    hkos_irq_state_t state = hkos_hal_irq_save();
+
+    hkos_tick_t ticks = hkos_scheduler_get_ticks();
+    uint16_t timestamp = (uint16_t)( (uint16_t)ticks * HKOS_HAL_TICK_FRACTIONS
+                                        + hkos_hal_get_tick_fraction() );
+
+    bool written = true;
+
+#if HKOS_TRACE_STREAM
+    if ( trace_data.lost > 0 ) {
+        written = put_record( timestamp, HKOS_TRACE_LOST, trace_data.lost );
+        if ( written )
+            trace_data.lost = 0;
+    }
+#endif
+
+    if ( written && ticks - trace_data.last_ticks >= TRACE_WRAP_TICKS ) {
+        written = put_record( timestamp, HKOS_TRACE_SYNC, (uint16_t)ticks );
+        if ( written )
+            trace_data.last_ticks = ticks;
+    }
+
+    if ( written ) {
+        written = put_record( timestamp, event, arg );
+        if ( written )
+            trace_data.last_ticks = ticks;
+    }
+
+#if HKOS_TRACE_STREAM
+    // The record is lost, but the task or ISR must not wait for the UART
+    if ( !written ) {
+        ++trace_data.dropped;
+        if ( trace_data.lost < UINT16_MAX )
+            ++trace_data.lost;
+    }
+#endif
+
+    hkos_hal_irq_restore( state );
+}
+
+#if !HKOS_TRACE_STREAM
+/******************************************************************************
+ * Take the oldest record out of the trace buffer
+ *
+ * @param[out]  p_record    The record
+ *
+ * @return  false if the trace buffer is empty
+ *
+ *****************************************************************************/
+bool hkos_trace_read( hkos_trace_record_t* p_record ) {
+
+    bool found = false;
+    hkos_irq_state_t state = hkos_hal_irq_save();
+
+    if ( trace_data.count > 0 ) {
+        uint16_t tail = ( trace_data.head + HKOS_TRACE_BUFFER - trace_data.count )
+                            % HKOS_TRACE_BUFFER;
+        *p_record = trace_data.buffer[ tail ];
+        --trace_data.count;
+        found = true;
+    }
+
+    hkos_hal_irq_restore( state );
+    return found;
+}
+#endif
+
+/******************************************************************************
+ * Get the number of records dropped because the buffer was full
+ *
+ * @return  The number of dropped records
+ *
+ *****************************************************************************/
+uint16_t hkos_trace_get_dropped( void ) {
+    return trace_data.dropped;
+}
+
+#endif // HKOS_TRACE
@@ -0,0 +1,194 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+#ifndef __HKOS_TRACE_H
+#define __HKOS_TRACE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <hkos_core.h>
+#include <hkos_config.h>
+
+// If HKOS_TRACE is not defined in hkos_config.h, define it as 0
+#ifndef HKOS_TRACE
+#define HKOS_TRACE                      0
+#endif
+
+// If HKOS_TRACE_STREAM is not defined in hkos_config.h, define it as 0
+#ifndef HKOS_TRACE_STREAM
+#define HKOS_TRACE_STREAM               0
+#endif
+
+#if HKOS_TRACE_STREAM && !HKOS_TRACE
+#error "HKOS_TRACE_STREAM requires HKOS_TRACE"
+#endif
+
+/******************************************************************************
+ * Kernel trace events
+ *
+ * The argument of each event is the lowest 16 bits of the address of the
+ * task, mutex or memory block involved, or the interrupt vector number.
+ *
+ *****************************************************************************/
+typedef enum {
+    HKOS_TRACE_SYNC,            // arg: lowest 16 bits of the tick counter
+    HKOS_TRACE_SWITCH_OUT,      // arg: task leaving the CPU, 0 for idle
+    HKOS_TRACE_SWITCH_IN,       // arg: task getting the CPU, 0 for idle
+    HKOS_TRACE_READY,           // arg: task
+    HKOS_TRACE_BLOCK,           // arg: task
+    HKOS_TRACE_MUTEX_LOCK,      // arg: mutex
+    HKOS_TRACE_MUTEX_UNLOCK,    // arg: mutex
+    HKOS_TRACE_ISR_ENTER,       // arg: interrupt vector
+    HKOS_TRACE_ISR_EXIT,        // arg: interrupt vector
+    HKOS_TRACE_ALLOC,           // arg: memory block, 0 if it failed
+    HKOS_TRACE_FREE,            // arg: memory block
+    HKOS_TRACE_LOST             // arg: records lost since the previous one
+} hkos_trace_event_t;
+
+/******************************************************************************
+ * Record an event
+ *
+ * When HKOS_TRACE is 0, it compiles to nothing, so the kernel calls cost
+ * nothing. ISRs can use it to record HKOS_TRACE_ISR_ENTER and
+ * HKOS_TRACE_ISR_EXIT.
+ *
+ *****************************************************************************/
+#if HKOS_TRACE
+#define HKOS_TRACE_EVENT( event, arg )  \
+            hkos_trace_event( (event), (uint16_t)(uintptr_t)( arg ) )
+#else
+#define HKOS_TRACE_EVENT( event, arg )  ( (void)0 )
+#endif
+
+// The trace is only available when enabled in hkos_config.h
+#if HKOS_TRACE
+
+// Number of records in the trace buffer. The buffer is a global variable,
+// so its size must be taken out of HKOS_AVAILABLE_RAM. A record holds five
+// bytes of data but takes 6 bytes, because the compiler pads it to the
+// alignment of its 16 bit fields, and the trace keeps 10 more bytes of
+// state, so the trace takes 6 * HKOS_TRACE_BUFFER + 10 bytes.
+#ifndef HKOS_TRACE_BUFFER
+#define HKOS_TRACE_BUFFER               16
+#endif
+
+/******************************************************************************
+ * Trace streaming
+ *
+ * With HKOS_TRACE_STREAM, there is no trace buffer. Each record is written
+ * to the tx buffer of serial port HKOS_TRACE_STREAM_PORT as a frame of
+ * HKOS_TRACE_FRAME_SIZE bytes:
+ *
+ *      0xA0 | event, timestamp (LSB first), arg (LSB first), checksum
+ *
+ * The checksum is the XOR of the other bytes of the frame. The application
+ * must open the port and should not write anything else to it. If a frame
+ * does not fit in the tx buffer, the record is lost and the task or ISR
+ * goes on. An HKOS_TRACE_LOST record tells how many records were lost as
+ * soon as there is space again. tools/hkos_trace2json.py turns the stream
+ * into a Chrome trace.
+ *
+ *****************************************************************************/
+#if HKOS_TRACE_STREAM
+
+#ifndef HKOS_TRACE_STREAM_PORT
+#define HKOS_TRACE_STREAM_PORT          0
+#endif
+
+#if HKOS_TRACE_STREAM_PORT >= HKOS_SERIAL_PORTS_ENABLE
+#error "HKOS_TRACE_STREAM_PORT must be an enabled serial port"
+#endif
+
+#define HKOS_TRACE_FRAME_SIZE           6
+#define HKOS_TRACE_FRAME_MARKER         0xA0
+
+#endif // HKOS_TRACE_STREAM
+
+/******************************************************************************
+ * HalfKOS trace record
+ *
+ * The record is not packed, so it takes 6 bytes: unaligned 16 bit accesses
+ * cost more code and time on the MSP430 than the padding byte costs RAM.
+ *
+ * The timestamp counts in 1/HKOS_HAL_TICK_FRACTIONS of a tick and wraps
+ * around. An HKOS_TRACE_SYNC record comes before any record that is more
+ * than one wrap after the previous one, so the reader can rebuild the time.
+ *
+ *****************************************************************************/
+typedef struct hkos_trace_record_t {
+    uint16_t                timestamp;
+    uint16_t                arg;
+    uint8_t                 event;
+} hkos_trace_record_t;
+
+
+/******************************************************************************
+ * Initialize the trace
+ *
+ * Called by hkos_init.
+ *
+ *****************************************************************************/
+void hkos_trace_init( void );
+
+
+/******************************************************************************
+ * Record an event in the trace buffer
+ *
+ * Use HKOS_TRACE_EVENT instead, so the call goes away when HKOS_TRACE is 0.
+ * It can be called from ISRs. When the buffer is full, the oldest record is
+ * dropped. When streaming, the new record is dropped instead.
+ *
+ * @param[in]   event       The event
+ * @param[in]   arg         The argument of the event
+ *
+ *****************************************************************************/
+void hkos_trace_event( hkos_trace_event_t event, uint16_t arg );
+
+
+#if !HKOS_TRACE_STREAM
+/******************************************************************************
+ * Take the oldest record out of the trace buffer
+ *
+ * @param[out]  p_record    The record
+ *
+ * @return  false if the trace buffer is empty
+ *
+ *****************************************************************************/
+bool hkos_trace_read( hkos_trace_record_t* p_record );
+#endif
+
+
+/******************************************************************************
+ * Get the number of records dropped because the buffer was full
+ *
+ * When streaming, it is the number of records that did not fit in the
+ * tx buffer of the serial port.
+ *
+ * @return  The number of dropped records
+ *
+ *****************************************************************************/
+uint16_t hkos_trace_get_dropped( void );
+
+#endif // HKOS_TRACE
+
+#endif //__HKOS_TRACE_H
@@ -0,0 +1,210 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+#include <stddef.h>
+#include <hkos_hal.h>
+#include <hkos_scheduler.h>
+#include <hkos_workqueue.h>
+
+// Work queues are only available when enabled in hkos_config.h
+#if HKOS_WORKQUEUES_ENABLE > 0
+
+/******************************************************************************
+ * HalfKOS work queue structure
+ *
+ * The work queue extends the worker task structure, so the worker finds its
+ * queue from the running task and no extra memory block is needed.
+ *
+ *****************************************************************************/
+typedef struct hkos_workqueue_t {
+    hkos_task_t         task;           // must be the first member
+    hkos_work_t*        p_first;        // waiting to run, in submit order
+    hkos_work_t*        p_last;
+    uint8_t             idle;           // worker waiting for a job
+} hkos_workqueue_t;
+
+/**************************************************************************
+ * Worker task
+ *
+ * Runs the jobs of its work queue and goes back to sleep until a job is
+ * submitted again.
+ *
+ * ************************************************************************/
+static void worker_task( void ) {
+
+    hkos_workqueue_t* p_wq =
+        (hkos_workqueue_t*)hkos_ram.runtime_data.p_running_task;
+
+    while( 1 ) {
+        hkos_hal_enter_critical_section();
+
+        hkos_work_t* p_work;
+        while ( ( p_work = p_wq->p_first ) != NULL ) {
+
+            p_wq->p_first = p_work->p_next;
+            if ( p_wq->p_first == NULL )
+                p_wq->p_last = NULL;
+
+            // the item belongs to the caller and may be submitted again by
+            // the job itself, so we don't touch it after this point
+            hkos_work_func_t p_func = p_work->p_func;
+            void* p_arg = p_work->p_arg;
+            p_work->p_next = NULL;
+            p_work->queued = false;
+
+            hkos_hal_exit_critical_section();
+            p_func( p_arg );
+            hkos_hal_enter_critical_section();
+        }
+
+        // only an idle worker is woken up, so a job that sleeps or waits
+        // is not cut short by the next submit
+        p_wq->idle = true;
+        hkos_hal_exit_critical_section();
+
+        hkos_scheduler_suspend();
+    }
+}
+
+/******************************************************************************
+ * Create a work queue
+ *
+ * @param[in]   stack_size      Stack of the worker task
+ *
+ * @return  Pointer to the work queue or NULL if it cannot be created.
+ *
+ *****************************************************************************/
+hkos_workqueue_t* hkos_workqueue_create( hkos_size_t stack_size ) {
+
+    hkos_hal_enter_critical_section();
+    hkos_workqueue_t* p_wq = hkos_scheduler_create_task( worker_task, NULL,
+                                                         stack_size,
+                                                         sizeof(hkos_workqueue_t) );
+    hkos_hal_exit_critical_section();
+
+    if ( p_wq != NULL ) {
+        p_wq->p_first = NULL;
+        p_wq->p_last = NULL;
+        p_wq->idle = false;
+        hkos_scheduler_start_task( p_wq );
+    }
+
+    return p_wq;
+}
+
+/******************************************************************************
+ * Submit a job to a work queue
+ *
+ * @param[in]   p_wq        Pointer to the work queue
+ * @param[in]   p_work      Work item owned by the caller
+ * @param[in]   p_func      Function to run
+ * @param[in]   p_arg       Argument passed to the function
+ *
+ * @return  false if the work item is already queued
+ *
+ *****************************************************************************/
+bool hkos_work_submit( hkos_workqueue_t* p_wq,
+                       hkos_work_t* p_work,
+                       hkos_work_func_t p_func,
+                       void* p_arg )
+{
+    if ( p_wq == NULL || p_work == NULL || p_func == NULL )
+        return false;
+
+    // it may be called from an interrupt service routine, so the interrupt
+    // state is preserved
+    hkos_irq_state_t state = hkos_hal_irq_save();
+
+    bool submitted = !p_work->queued;
+    bool must_yield = false;
+
+    if ( submitted ) {
+        p_work->p_func = p_func;
+        p_work->p_arg = p_arg;
+        p_work->p_next = NULL;
+        p_work->queued = true;
+
+        if ( p_wq->p_last == NULL ) {
+            p_wq->p_first = p_work;
+        } else {
+            p_wq->p_last->p_next = p_work;
+        }
+        p_wq->p_last = p_work;
+
+        if ( p_wq->idle ) {
+            p_wq->idle = false;
+            must_yield = hkos_scheduler_wake( p_wq );
+        }
+    }
+
+    hkos_hal_irq_restore( state );
+
+    // an interrupt service routine runs with the interrupts disabled and
+    // cannot switch, so the worker waits for the next switch
+    if ( must_yield && state )
+        hkos_scheduler_yield();
+
+    return submitted;
+}
+
+/******************************************************************************
+ * Cancel a job waiting in a work queue
+ *
+ * @param[in]   p_wq        Pointer to the work queue
+ * @param[in]   p_work      Work item submitted to the queue
+ *
+ * @return  false if the work item is not queued in the work queue
+ *
+ *****************************************************************************/
+bool hkos_work_cancel( hkos_workqueue_t* p_wq, hkos_work_t* p_work ) {
+
+    if ( p_wq == NULL || p_work == NULL )
+        return false;
+
+    hkos_irq_state_t state = hkos_hal_irq_save();
+
+    hkos_work_t* p_previous = NULL;
+    hkos_work_t* p_search = p_wq->p_first;
+
+    for (; p_search != NULL && p_search != p_work; p_search = p_search->p_next )
+        p_previous = p_search;
+
+    if ( p_search != NULL ) {
+        if ( p_previous == NULL ) {
+            p_wq->p_first = p_work->p_next;
+        } else {
+            p_previous->p_next = p_work->p_next;
+        }
+
+        if ( p_wq->p_last == p_work )
+            p_wq->p_last = p_previous;
+
+        p_work->p_next = NULL;
+        p_work->queued = false;
+    }
+
+    hkos_hal_irq_restore( state );
+
+    return p_search != NULL;
+}
+
+#endif // HKOS_WORKQUEUES_ENABLE > 0
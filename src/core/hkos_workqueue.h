@@ -0,0 +1,125 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+#ifndef __HKOS_WORKQUEUE_H
+#define __HKOS_WORKQUEUE_H
+
+#include <hkos_core.h>
+#include <hkos_config.h>
+
+// If HKOS_WORKQUEUES_ENABLE is not defined in hkos_config.h, define it as 0,
+// unless the event handlers, which run on a work queue, are enabled
+#ifndef HKOS_WORKQUEUES_ENABLE
+#if defined( HKOS_HANDLERS_ENABLE ) && HKOS_HANDLERS_ENABLE > 0
+#define HKOS_WORKQUEUES_ENABLE          1
+#else
+#define HKOS_WORKQUEUES_ENABLE          0
+#endif
+#endif
+
+// Work queues are only available when enabled in hkos_config.h
+#if HKOS_WORKQUEUES_ENABLE > 0
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+// Work function. It runs in the context of the worker task.
+typedef void (*hkos_work_func_t)( void* p_arg );
+
+/******************************************************************************
+ * HalfKOS work item structure
+ *
+ * Work items are owned by the caller, so submitting a job never allocates
+ * memory. A work item must be zeroed before its first use (static storage
+ * is) and must not be changed while it is queued.
+ *
+ *****************************************************************************/
+typedef struct hkos_work_t hkos_work_t; // forward declaration due to pointers
+typedef struct hkos_work_t {
+    hkos_work_t*            p_next;
+    hkos_work_func_t        p_func;
+    void*                   p_arg;
+    uint8_t                 queued;
+} hkos_work_t;
+
+// Work queue. Its structure is private to the work queue module.
+typedef struct hkos_workqueue_t hkos_workqueue_t;
+
+
+/******************************************************************************
+ * Create a work queue
+ *
+ * Creates the worker task that runs the jobs submitted to the queue, one
+ * after the other, in submission order. The queue and the worker share a
+ * single memory block.
+ *
+ * @param[in]   stack_size      Stack of the worker task. All the jobs of the
+ *                              queue run on this stack.
+ *
+ * @return  Pointer to the work queue or NULL if it cannot be created.
+ *
+ *****************************************************************************/
+hkos_workqueue_t* hkos_workqueue_create( hkos_size_t stack_size );
+
+
+/******************************************************************************
+ * Submit a job to a work queue
+ *
+ * Can be called from tasks, timer callbacks, other jobs and interrupt
+ * service routines. A work item can be submitted again as soon as its job
+ * starts running. Jobs may sleep and wait, which delays the next jobs of
+ * the queue.
+ *
+ * The worker task is made ready right away. Submitted from a task, the job
+ * runs at once if the worker preempts the task. Submitted from an interrupt
+ * service routine, it runs at the next context switch, which may be up to
+ * one tick later when the interrupted task keeps running or the CPU is idle.
+ *
+ * @param[in]   p_wq        Pointer to the work queue
+ * @param[in]   p_work      Work item owned by the caller
+ * @param[in]   p_func      Function to run
+ * @param[in]   p_arg       Argument passed to the function
+ *
+ * @return  false if the work item is already queued
+ *
+ *****************************************************************************/
+bool hkos_work_submit( hkos_workqueue_t* p_wq,
+                       hkos_work_t* p_work,
+                       hkos_work_func_t p_func,
+                       void* p_arg );
+
+
+/******************************************************************************
+ * Cancel a job waiting in a work queue
+ *
+ * A job that already started is not affected.
+ *
+ * @param[in]   p_wq        Pointer to the work queue
+ * @param[in]   p_work      Work item submitted to the queue
+ *
+ * @return  false if the work item is not queued in the work queue
+ *
+ *****************************************************************************/
+bool hkos_work_cancel( hkos_workqueue_t* p_wq, hkos_work_t* p_work );
+
+#endif // HKOS_WORKQUEUES_ENABLE > 0
+
+#endif //__HKOS_WORKQUEUE_H
@@ -39,11 +39,11 @@ extern hkos_error_code_t hkos_arch_serial_tx_pending( uint8_t port );
 
 
 // Ring buffers
-hkos_serial_ring_buffer hkos_serial_rx_buffer[HKOS_SERIAL_PORTS_ENABLE]  =  {{{ 0 },0,0}};
-hkos_serial_ring_buffer hkos_serial_tx_buffer[HKOS_SERIAL_PORTS_ENABLE]  =  {{{ 0 },0,0}};
+HKOS_INSTANCE_LOCAL hkos_serial_ring_buffer hkos_serial_rx_buffer[HKOS_SERIAL_PORTS_ENABLE]  =  {{{ 0 },0,0}};
+HKOS_INSTANCE_LOCAL hkos_serial_ring_buffer hkos_serial_tx_buffer[HKOS_SERIAL_PORTS_ENABLE]  =  {{{ 0 },0,0}};
 
 // Waiting tasks list
-hkos_task_t*    hkos_serial_blocked_tasks[HKOS_SERIAL_PORTS_ENABLE] = { 0 };
+HKOS_INSTANCE_LOCAL hkos_task_t* hkos_serial_blocked_tasks[HKOS_SERIAL_PORTS_ENABLE] = { 0 };
 
 /**************************************************************************
  * Open a serial port
@@ -140,6 +140,23 @@ void hkos_serial_signal_waiting_tasks( uint8_t port )
 }
 
 
+/**************************************************************************
+ * Forget a task waiting for characters in any serial port
+ *
+ * Called by the scheduler when the task is removed.
+ *
+ * @param[in]       p_task          The task being removed
+ *
+ * ************************************************************************/
+void hkos_serial_forget_task( void* p_task )
+{
+    for ( uint8_t port = 0; port < HKOS_SERIAL_PORTS_ENABLE; ++port ) {
+        if ( hkos_serial_blocked_tasks[port] == p_task )
+            hkos_serial_blocked_tasks[port] = 0;
+    }
+}
+
+
 /**************************************************************************
  * Read the number of bytes available in the serial port
  *
@@ -234,6 +251,43 @@ hkos_error_code_t hkos_serial_write_buffer( uint8_t port, char* data, uint16_t s
 }
 
 
+/**************************************************************************
+ * Perform a non-blocking write of a buffer to the serial port. Either the
+ * whole buffer fits in the tx buffer and is written or nothing is written.
+ *
+ * Caller is responsible for making sure this will not be preempted
+ *
+ * @param[in]       port            Port number
+ * @param[in]       data            The data to be written
+ * @param[in]       size            The size of the data to be written
+ *
+ * @return      HKOS_ERROR_NONE or HKOS_ERROR_RESOURCE_BUSY if there is
+ *              no space in the tx buffer
+ *
+ * ************************************************************************/
+hkos_error_code_t hkos_serial_try_write_buffer( uint8_t port,
+                                                const char* data,
+                                                uint16_t size )
+{
+    uint16_t head = hkos_serial_tx_buffer[port].head;
+    uint16_t used = (uint16_t)(HKOS_SERIAL_BUFFER_SIZE + head
+                        - hkos_serial_tx_buffer[port].tail) % HKOS_SERIAL_BUFFER_SIZE;
+
+    // one position is always left empty to tell a full buffer from an empty one
+    if ( size > HKOS_SERIAL_BUFFER_SIZE - 1 - used )
+        return HKOS_ERROR_RESOURCE_BUSY;
+
+    for ( uint16_t i = 0; i < size; ++i )
+    {
+        hkos_serial_tx_buffer[port].buffer[head] = data[i];
+        head = (head + 1) % HKOS_SERIAL_BUFFER_SIZE;
+    }
+    hkos_serial_tx_buffer[port].head = head;
+
+    return hkos_arch_serial_tx_pending( port );
+}
+
+
 /**************************************************************************
  * Write a NULL terminated string to the serial port.
  *
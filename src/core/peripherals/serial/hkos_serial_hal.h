@@ -123,6 +123,17 @@ uint16_t hkos_serial_wait( uint8_t port );
 void hkos_serial_signal_waiting_tasks( uint8_t port );
 
 
+/**************************************************************************
+ * Forget a task waiting for characters in any serial port
+ *
+ * Called by the scheduler when the task is removed.
+ *
+ * @param[in]       p_task          The task being removed
+ *
+ * ************************************************************************/
+void hkos_serial_forget_task( void* p_task );
+
+
 /**************************************************************************
  * Perform a non-blocking read of the number of bytes available in the
  * serial port
@@ -184,6 +195,26 @@ hkos_error_code_t hkos_serial_write( uint8_t port, char data );
 hkos_error_code_t hkos_serial_write_buffer( uint8_t port, char* data, uint16_t size );
 
 
+/**************************************************************************
+ * Perform a non-blocking write of a buffer to the serial port. Either the
+ * whole buffer fits in the tx buffer and is written or nothing is written.
+ *
+ * Caller is responsible for making sure this will not be preempted. It
+ * can be called from ISRs.
+ *
+ * @param[in]       port            Port number
+ * @param[in]       data            The data to be written
+ * @param[in]       size            The size of the data to be written
+ *
+ * @return      HKOS_ERROR_NONE or HKOS_ERROR_RESOURCE_BUSY if there is
+ *              no space in the tx buffer
+ *
+ * ************************************************************************/
+hkos_error_code_t hkos_serial_try_write_buffer( uint8_t port,
+                                                const char* data,
+                                                uint16_t size );
+
+
 /**************************************************************************
  * Write a NULL terminated string to the serial port.
  *
@@ -24,6 +24,11 @@
 
 #include <hkos_errors.h>
 #include <core/hkos_core.h>
+#include <core/hkos_timer.h>
+#include <core/hkos_handler.h>
+#include <core/hkos_workqueue.h>
+#include <core/hkos_trace.h>
+#include <core/hkos_profiler.h>
 #include <core/peripherals/gpio/hkos_gpio_hal.h>
 #include <core/peripherals/serial/hkos_serial_hal.h>
 
@@ -48,9 +53,259 @@ void hkos_init( void );
 void* hkos_add_task( void (*p_task_func)(), hkos_size_t stack_size );
 
 
+/******************************************************************************
+ * Add a task that receives an argument to HalfKOS scheduler
+ *
+ * The same task function can be added many times with different arguments,
+ * so there is no need for a wrapper function per task.
+ *
+ * @param[in]   p_task_func     Pointer to the task address
+ * @param[in]   p_arg           Argument passed to the task function
+ * @param[in]   stack_size      Size of the task's size
+ *
+ * @return  Pointer to the task structure or NULL if task cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_add_task_arg( void (*p_task_func)( void* ),
+                         void* p_arg,
+                         hkos_size_t stack_size );
+
+
+/******************************************************************************
+ * Add a periodic task to HalfKOS scheduler
+ *
+ * p_job is called once per period, starting when the task is added. The
+ * releases are absolute, so the time spent in the job does not make the
+ * period drift. If a job is still running when the next one should be
+ * released, an overrun is counted, the late job runs as soon as the current
+ * one finishes and releases missed entirely are skipped.
+ *
+ * @param[in]   p_job           Function executed once per period
+ * @param[in]   period_ms       Period of the task in milliseconds
+ * @param[in]   stack_size      Size of the task's size
+ *
+ * @return  Pointer to the task structure or NULL if task cannot be created.
+ *
+ *****************************************************************************/
+void* hkos_add_periodic_task( void (*p_job)(),
+                              uint32_t period_ms,
+                              hkos_size_t stack_size );
+
+
+/******************************************************************************
+ * Get the number of overruns of a periodic task
+ *
+ * @param[in]   p_task          Pointer to the task structure returned by
+ *                              hkos_add_periodic_task
+ *
+ * @return  Number of jobs that were still running at their next release
+ *
+ *****************************************************************************/
+uint16_t hkos_get_overruns( void* p_task );
+
+
+#if HKOS_SCHED_EDF
+/******************************************************************************
+ * Set the relative deadline of a periodic task
+ *
+ * By default, the deadline of a periodic task is its period. The task with
+ * the earliest absolute deadline (release + deadline) runs first.
+ *
+ * @param[in]   p_task          Pointer to the task structure returned by
+ *                              hkos_add_periodic_task
+ * @param[in]   deadline_ms     Deadline relative to each release in
+ *                              milliseconds
+ *
+ *****************************************************************************/
+void hkos_set_deadline( void* p_task, uint32_t deadline_ms );
+
+
+/******************************************************************************
+ * Get the number of deadline misses of a periodic task
+ *
+ * @param[in]   p_task          Pointer to the task structure returned by
+ *                              hkos_add_periodic_task
+ *
+ * @return  Number of jobs that finished after their absolute deadline
+ *
+ *****************************************************************************/
+uint16_t hkos_get_deadline_misses( void* p_task );
+#endif
+
+
+#if HKOS_PER_TASK_TIME_SLICE
+/******************************************************************************
+ * Set the time slice of a task
+ *
+ * Tasks start with HKOS_TIME_SLICE. Call this function right after adding
+ * the task to give it a different time slice from the start.
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ * @param[in]   time_slice_ms   Time slice in milliseconds. 0 makes the task
+ *                              run until it blocks
+ *
+ *****************************************************************************/
+void hkos_set_time_slice( void* p_task, uint16_t time_slice_ms );
+
+
+/******************************************************************************
+ * Get the number of times a task was preempted
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ *
+ * @return  Number of times the task lost the CPU without blocking
+ *
+ *****************************************************************************/
+uint16_t hkos_get_preemptions( void* p_task );
+#endif
+
+
+#if HKOS_SCHED_PRIORITY
+/******************************************************************************
+ * Set the priority and the preemption threshold of a task
+ *
+ * Tasks start with HKOS_DEFAULT_PRIORITY as priority and threshold. A ready
+ * task preempts the running one only if its priority is higher than the
+ * threshold of the running task. Giving a group of tasks a threshold equal
+ * to the highest priority in the group makes them never preempt each
+ * other, so they can share the worst case stack budget.
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ * @param[in]   priority        Priority of the task. Higher runs first
+ * @param[in]   threshold       Preemption threshold. It is raised to the
+ *                              priority if lower
+ *
+ *****************************************************************************/
+void hkos_set_priority( void* p_task, uint8_t priority, uint8_t threshold );
+#endif
+
+
+#if HKOS_SWITCH_COUNTER
+/******************************************************************************
+ * Get the number of context switches since HalfKOS started
+ *
+ * @return  The number of times the running task (or idle) changed
+ *
+ *****************************************************************************/
+uint32_t hkos_get_switches( void );
+#endif
+
+
+#if HKOS_TASK_RESTART
+/******************************************************************************
+ * Restart a task
+ *
+ * The task starts again from its task function, reusing its memory, so no
+ * allocation is needed and it cannot fail for lack of memory. The task may
+ * be ready or waiting for anything, but a task cannot restart itself.
+ * Mutexes locked by the task are not released.
+ *
+ * @param[in]   p_task          Pointer to the task structure returned by
+ *                              hkos_add_task
+ *
+ * @return  false if the task cannot be restarted
+ *
+ *****************************************************************************/
+bool hkos_restart_task( void* p_task );
+#endif
+
+
+#if HKOS_PAINT_TASK_STACK
+/******************************************************************************
+ * Get the number of bytes of a task stack that were never used
+ *
+ * The stacks are painted when created, so this is the stack size (plus the
+ * space reserved for the context) less the deepest the task has ever gone.
+ * Run the application through its worst case and trim the stack size to
+ * the measured usage plus a margin.
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ *
+ * @return  Number of bytes never used
+ *
+ *****************************************************************************/
+hkos_size_t hkos_get_stack_unused( void* p_task );
+
+
+/******************************************************************************
+ * Get the number of bytes of the os stack that were never used
+ *
+ * The os stack is used by idle and by the interrupts that arrive when the
+ * CPU is idle. Its size is HKOS_IDLE_STACK.
+ *
+ * @return  Number of bytes never used
+ *
+ *****************************************************************************/
+hkos_size_t hkos_get_os_stack_unused( void );
+#endif
+
+
+#if HKOS_TASK_STATS
+/******************************************************************************
+ * Get the statistics of a task
+ *
+ * The run time is the CPU time used by the task since it was added. The
+ * switch counters tell how many times it left the CPU by blocking or
+ * yielding and how many times it was preempted.
+ *
+ * @param[in]   p_task          Pointer to the task structure
+ * @param[out]  p_stats         The statistics of the task
+ *
+ *****************************************************************************/
+void hkos_get_task_stats( void* p_task, hkos_task_stats_t* p_stats );
+
+
+/******************************************************************************
+ * Get the time the CPU was idle since HalfKOS started
+ *
+ * @param[out]  p_idle          The idle time
+ *
+ *****************************************************************************/
+void hkos_get_idle_time( hkos_run_time_t* p_idle );
+
+
+/******************************************************************************
+ * Get the CPU load since the previous call
+ *
+ * Call it periodically, e.g. once a second, to follow the load. At 1000
+ * ticks per second, calls must be less than 35 minutes apart on MSP430.
+ *
+ * @return  Percentage of the time the CPU was not idle
+ *
+ *****************************************************************************/
+uint8_t hkos_get_cpu_load( void );
+#endif
+
+
+#if HKOS_IRQ_STATS
+/******************************************************************************
+ * Get the interrupt statistics
+ *
+ * The longest time the kernel kept the interrupts disabled, the address of
+ * the code that disabled them, and the longest latency of a test interrupt,
+ * all since HalfKOS started or since hkos_reset_irq_stats.
+ *
+ * @param[out]  p_stats         The interrupt statistics
+ *
+ *****************************************************************************/
+void hkos_get_irq_stats( hkos_irq_stats_t* p_stats );
+
+
+/******************************************************************************
+ * Discard the interrupt statistics
+ *
+ *****************************************************************************/
+void hkos_reset_irq_stats( void );
+#endif
+
+
 /******************************************************************************
  * Remove a task from HalfKOS scheduler
  *
+ * The task may be ready or waiting for anything. A task may also remove
+ * itself, which is the same as returning from its task function. Mutexes
+ * locked by the task are not released.
+ *
  * @param[in]   p_task_in       Pointer to the task structure returned by
  *                              hkos_add_task
  *
@@ -106,10 +361,70 @@ void hkos_destroy_mutex( void* p_mutex );
 /******************************************************************************
  * Suspend the callee for the specified time
  *
+ * The time is rounded up to the next tick. A time of 0 suspends the callee
+ * until it is signalled, as hkos_suspend does.
+ *
  * @param[in]       time_ms     The time to suspend the task in milliseconds
  *
  * ***************************************************************************/
-void hkos_sleep( uint16_t time_ms );
+void hkos_sleep( uint32_t time_ms );
+
+
+/******************************************************************************
+ * Suspend the callee until its next periodic release
+ *
+ * Typical usage:
+ *
+ *      hkos_tick_t last_wake = hkos_get_ticks();
+ *      while ( 1 ) {
+ *          do_work();
+ *          hkos_sleep_until( &last_wake, 10 );
+ *      }
+ *
+ * As in hkos_sleep, signalling the callee wakes it up early.
+ *
+ * @param[inout]    p_last_wake     The previous release time in ticks. It
+ *                                  is advanced by one period.
+ * @param[in]       period_ms       The period in milliseconds
+ *
+ * @return  false if the release time had already been reached, in which case
+ *          the callee does not sleep.
+ *
+ * ***************************************************************************/
+bool hkos_sleep_until( hkos_tick_t* p_last_wake, uint32_t period_ms );
+
+
+/******************************************************************************
+ * Get the number of ticks since HalfKOS started
+ *
+ * The counter wraps around. Use hkos_tick_reached to compare ticks.
+ *
+ * @return  The tick counter
+ *
+ * ***************************************************************************/
+hkos_tick_t hkos_get_ticks( void );
+
+
+/******************************************************************************
+ * Get the time since HalfKOS started
+ *
+ * Computed from the tick counter, so it wraps around with it.
+ *
+ * @return  The uptime in milliseconds
+ *
+ * ***************************************************************************/
+hkos_tick_t hkos_uptime_ms( void );
+
+
+/******************************************************************************
+ * Yield the execution to another ready task
+ *
+ * Without preemption (HKOS_PREEMPTION set to 0), long running tasks must
+ * call this function to let the other tasks run. With HKOS_SCHED_PRIORITY,
+ * the task goes behind the ready tasks with the same effective priority.
+ *
+ * ***************************************************************************/
+void hkos_yield( void );
 
 
 /******************************************************************************
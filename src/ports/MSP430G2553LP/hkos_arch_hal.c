@@ -29,6 +29,7 @@
 #include <msp430.h>
 #include <core/hkos_hal.h>
 #include <core/hkos_scheduler.h>
+#include <core/hkos_hooks.h>
 #include <stdbool.h>
 #include <stddef.h>
 
@@ -37,6 +38,17 @@
 #define BIT(x)          (1 << x)
 #define arraysize(x)    (sizeof(x) / sizeof(x[0]))
 
+// Timer1 A counts the CPU cycles when any of these features is enabled
+#define CYCLE_COUNTER   ( HKOS_PROF_REGIONS > 0 || HKOS_IRQ_STATS )
+
+#if HKOS_IRQ_STATS
+// Period of the interrupt latency test in cycles. It is not a divisor of
+// the tick period, so the test interrupt hits every point of the tick.
+#ifndef HKOS_IRQ_STATS_PERIOD
+#define HKOS_IRQ_STATS_PERIOD   9973
+#endif
+#endif
+
 /******************************************************************************
  *  Helper function to disable the watchdog timer
  *
@@ -88,15 +100,82 @@ static inline void init_timerA( void ) {
     TACTL = MC_0;
 
     // Set the counter
-    // Since system is going to be configured to up and down mode,
-    // it will count twice TA0CCR0 to get an interrupt. So, each
-    // each unit in TA0CCR0 will be 1us
-    TA0CCR0 = 1000000/HKOS_HAL_TICKS_IN_A_SECOND;
+    // In up mode, the timer counts from 0 to TA0CCR0, so TAR is the time
+    // since the last tick in units of 0.5us
+    TA0CCR0 = HKOS_HAL_TICK_FRACTIONS - 1;
 
-    // DCO, DCO/8, up and down mode
+    // DCO, DCO/8, up mode
     // 2MHz oscillator
-    TACTL = TASSEL_2 | ID_3 | MC_3;
+    TACTL = TASSEL_2 | ID_3 | MC_1;
+}
+
+#if CYCLE_COUNTER
+// Number of times timer1 A wrapped. The higher 16 bits of the cycle counter
+static volatile uint16_t cycle_overflows;
+
+/******************************************************************************
+ * Initialize timer1 A as the cycle counter
+ *
+ * Timer0 A is the tick timer, so timer1 A counts the CPU cycles. With
+ * HKOS_IRQ_STATS, its CCR1 also generates the latency test interrupt.
+ *
+ *****************************************************************************/
+static inline void init_timer1A( void ) {
+    cycle_overflows = 0;
+
+#if HKOS_IRQ_STATS
+    TA1CCR1 = HKOS_IRQ_STATS_PERIOD;
+    TA1CCTL1 = CCIE;
+#endif
+
+    // DCO, continuous mode, interrupt when it wraps
+    // 16MHz, one count per CPU cycle
+    TA1CTL = TASSEL_2 | MC_2 | TACLR | TAIE;
+}
+#endif
+
+#if HKOS_IRQ_STATS
+/******************************************************************************
+ * Interrupt statistics runtime data
+ *
+ *****************************************************************************/
+static hkos_irq_stats_t irq_stats;
+static uint32_t irq_disabled_start;
+static uintptr_t irq_disabled_site;     // 0 if not being measured
+
+/******************************************************************************
+ * Start measuring the time with interrupts disabled
+ *
+ * Must be called after disabling the interrupts
+ *
+ * @param[in]   site        The address of the code disabling them
+ *
+ *****************************************************************************/
+static inline void irq_disabled_begin( uintptr_t site ) {
+    irq_disabled_start = hkos_hal_get_cycles();
+    irq_disabled_site = site;
+}
+
+/******************************************************************************
+ * Finish measuring the time with interrupts disabled
+ *
+ * Must be called before enabling the interrupts
+ *
+ *****************************************************************************/
+static inline void irq_disabled_end( void ) {
+
+    // the interrupts were disabled by an ISR or before HalfKOS started
+    if ( irq_disabled_site == 0 )
+        return;
+
+    uint32_t elapsed = hkos_hal_get_cycles() - irq_disabled_start;
+    if ( elapsed > irq_stats.max_disabled ) {
+        irq_stats.max_disabled = elapsed;
+        irq_stats.max_disabled_site = irq_disabled_site;
+    }
+    irq_disabled_site = 0;
 }
+#endif
 
 /******************************************************************************
  * Before doing anything, we need to restart the stack. Stack is set to the
@@ -144,9 +223,30 @@ void hkos_hal_init( void ) {
     restart_stack();
     init_dco();
     init_timerA();
+#if CYCLE_COUNTER
+    init_timer1A();
+#endif
     __enable_interrupt();
 }
 
+#if !HKOS_PREEMPTION
+/******************************************************************************
+ * Task entry point without preemption
+ *
+ * The initial frame has no room for r12, where MSP430 GCC passes the first
+ * argument. So, the task starts here with the argument in r4 and the task
+ * address in r5, which are part of the frame.
+ *
+ *****************************************************************************/
+__attribute__((naked))
+static void task_entry( void ) {
+    asm volatile (
+        "   mov.w   r4,              r12    \n\t"
+        "   br      r5                      \n\t"
+    );
+}
+#endif
+
 /******************************************************************************
  * Initialize the task stack.
  *
@@ -155,25 +255,38 @@ void hkos_hal_init( void ) {
  * in such a way that when returning from the interrupt, all the data is
  * already in the proper places.
  *
+ * Without preemption, a task only leaves the CPU by calling a function, so
+ * the caller saved registers (r11-r15) are not part of the context.
+ *
+ * Below the initial frame, there is the address of hkos_scheduler_exit_task,
+ * so a task function that returns jumps there and is removed.
+ *
+ * The task argument goes in r12, the first argument register of MSP430 GCC.
+ * Without preemption, task_entry moves it there.
+ *
  * @param[in]   pp_sp       a pointer to the stack pointer indicating the
  *                          memory region of the task stack
  * @param[in]   p_pc        a pointer to the beginning of the task code
+ * @param[in]   p_arg       the argument of the task code
  * @param[in]   stack_size  the size of the task's stack
  *
  * @return  The value of stack pointer after the stack initialization
  *
  *****************************************************************************/
-void* hkos_hal_init_stack( void* p_sp, void* p_pc, hkos_size_t stack_size ){
-
+void* hkos_hal_init_stack( void* p_sp, void* p_pc, void* p_arg,
+                           hkos_size_t stack_size )
+{
     uint16_t* p_stack = (uint16_t*)p_sp;
 
 
+    *--p_stack = (uint16_t)hkos_scheduler_exit_task;
+#if HKOS_PREEMPTION
     *--p_stack = (uint16_t)p_pc;
     *--p_stack = (uint16_t)GIE;
     *--p_stack = (uint16_t)0xFFFF; // R15
     *--p_stack = (uint16_t)0xEEEE; // R14
     *--p_stack = (uint16_t)0xDDDD; // R13
-    *--p_stack = (uint16_t)0xCCCC; // R12
+    *--p_stack = (uint16_t)p_arg;  // R12
     *--p_stack = (uint16_t)0xBBBB; // R11
     *--p_stack = (uint16_t)0xAAAA; // R10
     *--p_stack = (uint16_t)0x9999; // R9
@@ -182,6 +295,17 @@ void* hkos_hal_init_stack( void* p_sp, void* p_pc, hkos_size_t stack_size ){
     *--p_stack = (uint16_t)0x6666; // R6
     *--p_stack = (uint16_t)0x5555; // R5
     *--p_stack = (uint16_t)0x4444; // R4
+#else
+    *--p_stack = (uint16_t)task_entry;
+    *--p_stack = (uint16_t)GIE;
+    *--p_stack = (uint16_t)0xAAAA; // R10
+    *--p_stack = (uint16_t)0x9999; // R9
+    *--p_stack = (uint16_t)0x8888; // R8
+    *--p_stack = (uint16_t)0x7777; // R7
+    *--p_stack = (uint16_t)0x6666; // R6
+    *--p_stack = (uint16_t)p_pc;   // R5
+    *--p_stack = (uint16_t)p_arg;  // R4
+#endif
 
     uint16_t* ret_stack = p_stack;
 
@@ -211,13 +335,21 @@ void* hkos_hal_init_stack( void* p_sp, void* p_pc, hkos_size_t stack_size ){
  *          + 2 Bytes for SR
  *          + 12*2 Bytes for GP registers
  *          + 2 Bytes for the context switch call
+ *          + 2 Bytes for the task exit return address
  *
- *          = 30 bytes
+ *          = 32 bytes
+ *
+ * Without preemption, only the 7 callee saved registers (r4-r10) are
+ * stored, so it is 22 bytes.
  *
  *****************************************************************************/
 inline hkos_size_t hkos_hal_get_min_stack_size( void ) {
-    return 30; // better define it here than at the beginning of this file.
+#if HKOS_PREEMPTION
+    return 32; // better define it here than at the beginning of this file.
                // less mind jumps when analysing the code.
+#else
+    return 22;
+#endif
 }
 
 
@@ -276,7 +408,14 @@ void hkos_hal_jump_to_os( void ) {
         "call       #start_tick_timer       \n\t" // starts the tick timer
         "reti                               \n\t" // RETI will update PC and SR
     "hkos_idle:                             \n\t"
+#if HKOS_PREEMPTION
         "jmp        hkos_idle               \n\t" // when idle, we do nothing
+#else
+        // without preemption, the tick timer wakes up the idle loop when a
+        // task is ready and the idle loop yields to it
+        "call       #hkos_scheduler_yield   \n\t"
+        "jmp        hkos_idle               \n\t"
+#endif
         :
         : "i" (&hkos_ram.os_stack[0]), "i" (sizeof(hkos_ram.os_stack)),
                     "m" (hkos_ram.runtime_data.p_idle_sp),
@@ -302,7 +441,14 @@ void hkos_hal_jump_to_os( void ) {
  *
  *****************************************************************************/
 void hkos_hal_enter_critical_section( void ) {
+#if HKOS_IRQ_STATS
+    bool enabled = __get_SR_register() & GIE;
+    __disable_interrupt();
+    if ( enabled )
+        irq_disabled_begin( (uintptr_t)__builtin_return_address( 0 ) );
+#else
     __disable_interrupt();
+#endif
 }
 
 /******************************************************************************
@@ -320,9 +466,133 @@ void hkos_hal_enter_critical_section( void ) {
  *
  *****************************************************************************/
 void hkos_hal_exit_critical_section( void ) {
+#if HKOS_IRQ_STATS
+    irq_disabled_end();
+#endif
     __enable_interrupt();
 }
 
+/******************************************************************************
+ * Save the interrupt state and disable interrupts
+ *
+ * In case of MSP430, the interrupt state is the GIE bit of SR
+ *
+ * @return  The interrupt state before the call
+ *
+ *****************************************************************************/
+hkos_irq_state_t hkos_hal_irq_save( void ) {
+    hkos_irq_state_t state = __get_SR_register() & GIE;
+    __disable_interrupt();
+#if HKOS_IRQ_STATS
+    if ( state & GIE )
+        irq_disabled_begin( (uintptr_t)__builtin_return_address( 0 ) );
+#endif
+    return state;
+}
+
+/******************************************************************************
+ * Restore the interrupt state saved by hkos_hal_irq_save
+ *
+ * @param[in]   state       The state returned by hkos_hal_irq_save
+ *
+ *****************************************************************************/
+void hkos_hal_irq_restore( hkos_irq_state_t state ) {
+    if ( state & GIE ) {
+#if HKOS_IRQ_STATS
+        irq_disabled_end();
+#endif
+        __enable_interrupt();
+    }
+}
+
+/******************************************************************************
+ * Get the time elapsed since the last tick
+ *
+ * If the counter wrapped after the first read, CCIFG is set and TAR is read
+ * again, so the result is consistent with the flag.
+ *
+ * @return  Time since the last tick in 1/HKOS_HAL_TICK_FRACTIONS of a tick
+ *
+ *****************************************************************************/
+uint16_t hkos_hal_get_tick_fraction( void ) {
+    uint16_t fraction = TAR;
+
+    // the tick timer interrupt is pending. CCIFG is set when TAR reaches
+    // TA0CCR0, one count before it wraps to 0.
+    if ( TACCTL0 & CCIFG ) {
+        fraction = TAR;
+        if ( fraction != HKOS_HAL_TICK_FRACTIONS - 1 )
+            fraction += HKOS_HAL_TICK_FRACTIONS;
+    }
+
+    return fraction;
+}
+
+#if CYCLE_COUNTER
+/******************************************************************************
+ * Get the cycle counter
+ *
+ * If the counter wrapped and the interrupt is still pending, the overflow
+ * is counted here and TA1R is read again, so the result is consistent with
+ * the flag.
+ *
+ * @return  The cycle counter
+ *
+ *****************************************************************************/
+uint32_t hkos_hal_get_cycles( void ) {
+    uint16_t high = cycle_overflows;
+    uint16_t low = TA1R;
+
+    if ( TA1CTL & TAIFG ) {
+        low = TA1R;
+        ++high;
+    }
+
+    return ( (uint32_t)high << 16 ) | low;
+}
+#endif
+
+#if HKOS_IRQ_STATS
+/******************************************************************************
+ * Get the interrupt statistics
+ *
+ * @param[out]  p_stats     The statistics
+ *
+ *****************************************************************************/
+void hkos_hal_get_irq_stats( hkos_irq_stats_t* p_stats ) {
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    *p_stats = irq_stats;
+    hkos_hal_irq_restore( state );
+}
+
+/******************************************************************************
+ * Discard the interrupt statistics
+ *
+ *****************************************************************************/
+void hkos_hal_reset_irq_stats( void ) {
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    irq_stats = (hkos_irq_stats_t){ 0, 0, 0, 0 };
+    hkos_hal_irq_restore( state );
+}
+#endif
+
+#if HKOS_PREEMPTION
+/******************************************************************************
+ * Get the program counter saved in the context of a task
+ *
+ * The interrupt frame saved by save_context_from_interrupt is r4 to r15,
+ * SR and PC, from the saved stack pointer up.
+ *
+ * @param[in]   p_sp        The stack pointer saved in the task structure
+ *
+ * @return  The address the task was executing when it was interrupted
+ *
+ *****************************************************************************/
+uintptr_t hkos_hal_get_saved_pc( void* p_sp ) {
+    return ((uint16_t*)p_sp)[13];
+}
+#endif
+
 /******************************************************************************
  * Save context for a context switch (interrupt version)
  *
@@ -334,6 +604,7 @@ void hkos_hal_exit_critical_section( void ) {
  * This version is intended to be called from an interrupt.
  *
  *****************************************************************************/
+#if HKOS_PREEMPTION
 __attribute__((naked))
 static void save_context_from_interrupt( void ) {
 
@@ -379,6 +650,7 @@ static void save_context_from_interrupt( void ) {
             :
     );
 }
+#endif // HKOS_PREEMPTION
 
 
 /******************************************************************************
@@ -393,6 +665,7 @@ static void save_context_from_interrupt( void ) {
  * simulate an interrupt by pushing SR (R2 to the stack).
  *
  *****************************************************************************/
+#if HKOS_PREEMPTION
 __attribute__((naked))
 void hkos_hal_save_context( void ) {
 
@@ -439,6 +712,46 @@ void hkos_hal_save_context( void ) {
             :
     );
 }
+#else
+__attribute__((naked))
+void hkos_hal_save_context( void ) {
+
+    // Without preemption, this is only called through hkos_scheduler_yield,
+    // which is called as a regular function. So, the compiler has already
+    // saved the caller saved registers (r11-r15) and we can use them freely.
+    //      1. Pop the PC to which we will return at the end of this function
+    //      2. Push SR over it, so the task's return address and SR make an
+    //         interrupt frame
+    //      3. Disable interrupts, so the scheduler is not disturbed by the
+    //         tick timer. The SR we saved will enable them again.
+    //      4. If there is a current task, push the callee saved registers
+    //         and save the stack pointer
+    //      5. Jump back to the calling function
+    asm volatile (
+        "   pop     r15                     \n\t"
+        "   push    r2                      \n\t"
+        "   dint                            \n\t"
+        "   nop                             \n\t"
+        "   cmp     #0,               %0    \n\t"
+        "   jz      done_save               \n\t"
+        "   push    r10                     \n\t"
+        "   push    r9                      \n\t"
+        "   push    r8                      \n\t"
+        "   push    r7                      \n\t"
+        "   push    r6                      \n\t"
+        "   push    r5                      \n\t"
+        "   push    r4                      \n\t"
+        "   mov.w   %0,              r14    \n\t"
+        "   mov.w   r1,         %c1(r14)    \n\t"
+        "done_save:                         \n\t"
+        "   br      r15                     \n\t"
+            :
+            :   "m" (hkos_ram.runtime_data.p_running_task),
+                "i" ( offsetof( hkos_task_t, p_sp ) )
+            :
+    );
+}
+#endif // HKOS_PREEMPTION
 
 /******************************************************************************
  * Restore context after a context switch
@@ -467,20 +780,29 @@ void hkos_hal_restore_context( void ) {
         "   pop     r8                      \n\t"
         "   pop     r9                      \n\t"
         "   pop     r10                     \n\t"
+#if HKOS_PREEMPTION
         "   pop     r11                     \n\t"
         "   pop     r12                     \n\t"
         "   pop     r13                     \n\t"
         "   pop     r14                     \n\t"
         "   pop     r15                     \n\t"
+#endif
         "   jmp     done_restore            \n\t"
         "go_idle:                           \n\t"
         "   mov.w   %2,               r1    \n\t"
+#if !HKOS_PREEMPTION
+        // the idle loop yields from the idle stack and the tick timer clears
+        // the low power bits of its SR, so its frame is written again
+        "   mov.w   %3,             0(r1)   \n\t"
+        "   mov.w   #hkos_idle,     2(r1)   \n\t"
+#endif
         "done_restore:                      \n\t"
         "   reti                            \n\t"
             :
             :   "m" ( hkos_ram.runtime_data.p_running_task ),
                 "i" ( offsetof( hkos_task_t, p_sp ) ),
-                "m" ( hkos_ram.runtime_data.p_idle_sp )
+                "m" ( hkos_ram.runtime_data.p_idle_sp ),
+                "i" ( GIE+LPM1_bits )
             :
     );
 }
@@ -498,10 +820,58 @@ void hkos_hal_restore_context( void ) {
  * OBS: RETI is executed by hkos_hal_restore_context
  *
  *****************************************************************************/
+#if HKOS_PREEMPTION
 __attribute__((naked))
 __attribute__((interrupt(TIMER0_A0_VECTOR)))
 void timer_a0_isr(void) {
     save_context_from_interrupt();
+    HKOS_HOOK_ISR_ENTER( TIMER0_A0_VECTOR );
     hkos_scheduler_tick_timer();
+    HKOS_HOOK_ISR_EXIT( TIMER0_A0_VECTOR );
     hkos_hal_restore_context();
 }
+#else
+__attribute__((interrupt(TIMER0_A0_VECTOR)))
+void timer_a0_isr(void) {
+    // Without preemption, the tick never switches the task, so this is a
+    // regular interrupt. If the CPU is idle and a task became ready, leave
+    // the low power mode so the idle loop yields to it.
+    HKOS_HOOK_ISR_ENTER( TIMER0_A0_VECTOR );
+    hkos_scheduler_tick_timer();
+
+    if ( hkos_ram.runtime_data.p_running_task == NULL &&
+         hkos_ram.runtime_data.p_ready_tasks != NULL ) {
+        __bic_SR_register_on_exit( LPM1_bits );
+    }
+    HKOS_HOOK_ISR_EXIT( TIMER0_A0_VECTOR );
+}
+#endif
+
+#if CYCLE_COUNTER
+/******************************************************************************
+ * TIMER1_A1 ISR. Extends the cycle counter to 32 bits
+ *
+ * With HKOS_IRQ_STATS, it also measures the latency of the CCR1 interrupt,
+ * i.e., how long after CCR1 matched the counter this code runs.
+ *
+ *****************************************************************************/
+__attribute__((interrupt(TIMER1_A1_VECTOR)))
+void timer_a1_isr(void) {
+    // reading TA1IV clears the flag of the interrupt being served
+    switch ( TA1IV ) {
+#if HKOS_IRQ_STATS
+    case TA1IV_TACCR1: {
+        uint16_t latency = TA1R - TA1CCR1;
+        TA1CCR1 += HKOS_IRQ_STATS_PERIOD;
+        if ( latency > irq_stats.max_latency )
+            irq_stats.max_latency = latency;
+        ++irq_stats.latency_samples;
+        break;
+    }
+#endif
+    case TA1IV_TAIFG:
+        ++cycle_overflows;
+        break;
+    }
+}
+#endif
@@ -28,6 +28,9 @@
 #define HKOS_HAL_TICKS_IN_A_SECOND              1000
 #define F_CPU                                   16000000L
 
+// Timer A counts DCO/8 in up mode, so each tick has this many counts
+#define HKOS_HAL_TICK_FRACTIONS                 ( F_CPU / 8 / HKOS_HAL_TICKS_IN_A_SECOND )
+
 // Configure the data type of the dynamic memory
 // allocation block header. Besides the size requested
 // during the allocation, the number of bytes of the data
@@ -37,4 +40,7 @@
 // Hence, blocks can be up to 2^(datatype bits - 1) long.
 typedef uint16_t                    hkos_dmem_header_t;
 
+// Data type used to save the interrupt state (the GIE bit of SR)
+typedef uint16_t                    hkos_irq_state_t;
+
 #endif // __HKOS_ARCH_HAL_H
@@ -30,6 +30,7 @@
 #include <hkos_errors.h>
 #include <core/hkos_hal.h>
 #include <core/hkos_scheduler.h>
+#include <core/hkos_hooks.h>
 #include <core/peripherals/serial/hkos_serial_hal.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -187,6 +188,8 @@ hkos_error_code_t hkos_arch_serial_tx_pending( uint8_t port )
 __attribute__((interrupt(USCIAB0RX_VECTOR)))
 void USCIAB0RX_ISR(void)
 {
+    HKOS_HOOK_ISR_ENTER( USCIAB0RX_VECTOR );
+
     uint8_t port = 0;
     uint16_t i = (hkos_serial_rx_buffer[port].head + 1) % HKOS_SERIAL_BUFFER_SIZE;
 
@@ -197,6 +200,8 @@ void USCIAB0RX_ISR(void)
 		hkos_serial_rx_buffer[port].head = i;
 	}
     hkos_serial_signal_waiting_tasks( port );
+
+    HKOS_HOOK_ISR_EXIT( USCIAB0RX_VECTOR );
 }
 
 
@@ -207,6 +212,12 @@ void USCIAB0RX_ISR(void)
 __attribute__((interrupt(USCIAB0TX_VECTOR)))
 void USCIAB0TX_ISR(void)
 {
+    // When streaming the trace, this interrupt sends the trace itself. So
+    // it is not recorded, or every byte sent would make more to send.
+#if !HKOS_TRACE_STREAM
+    HKOS_HOOK_ISR_ENTER( USCIAB0TX_VECTOR );
+#endif
+
     uint8_t port = 0;
 
     if (hkos_serial_tx_buffer[port].head == hkos_serial_tx_buffer[port].tail)
@@ -216,12 +227,15 @@ void USCIAB0TX_ISR(void)
         // Set the flag for the next write. There we enable
         // interrupts and we will run this ISR again
 		IFG2 |= UCA0TXIFG;
-		return;
+	} else {
+		char c = hkos_serial_tx_buffer[port].buffer[hkos_serial_tx_buffer[port].tail];
+		hkos_serial_tx_buffer[port].tail = (hkos_serial_tx_buffer[port].tail + 1) % HKOS_SERIAL_BUFFER_SIZE;
+		UCA0TXBUF = c;
 	}
 
-	char c = hkos_serial_tx_buffer[port].buffer[hkos_serial_tx_buffer[port].tail];
-	hkos_serial_tx_buffer[port].tail = (hkos_serial_tx_buffer[port].tail + 1) % HKOS_SERIAL_BUFFER_SIZE;
-	UCA0TXBUF = c;
+#if !HKOS_TRACE_STREAM
+    HKOS_HOOK_ISR_EXIT( USCIAB0TX_VECTOR );
+#endif
 }
 
 #endif// HKOS_SERIAL_PORTS_ENABLE > 0
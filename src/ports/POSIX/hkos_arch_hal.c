@@ -0,0 +1,541 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/**************************************************************************
+ *
+ * HalfKOS Hardware Abstraction Layer implementation for POSIX hosts
+ *
+ * HalfKOS runs in a single process and thread:
+ *
+ *      - each task runs on its own host stack and contexts are switched
+ *        with ucontext
+ *      - the idle loop runs on the stack of main
+ *      - SIGALRM, sent by an interval timer, is the tick timer interrupt
+ *      - disabling interrupts is blocking SIGALRM
+ *
+ * ************************************************************************/
+#define _GNU_SOURCE
+#include <core/hkos_hal.h>
+#include <core/hkos_scheduler.h>
+#include <core/hkos_hooks.h>
+#include <core/peripherals/serial/hkos_serial_hal.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+
+// General Macros
+//
+#define arraysize(x)    (sizeof(x) / sizeof(x[0]))
+
+// The signal used as the tick timer interrupt
+#define TICK_SIGNAL     SIGALRM
+
+// Tick period in nanoseconds
+#define TICK_PERIOD_NS  ( 1000000000L / HKOS_HAL_TICKS_IN_A_SECOND )
+
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+// Serial port receivers are polled by the tick timer interrupt
+extern void hkos_arch_serial_poll( void );
+#endif
+
+/******************************************************************************
+ * Host context of a task
+ *
+ * Contexts are never freed. They belong to the memory block of a task and
+ * are reused by the next task whose stack starts at the same address.
+ *
+ *****************************************************************************/
+typedef struct hkos_posix_context_t {
+    ucontext_t                      context;
+    void*                           p_top;      // stack top in hkos_ram
+    void                            (*p_entry)( void* );
+    void*                           p_arg;
+    uint8_t*                        p_stack;    // host stack
+    struct hkos_posix_context_t*    p_next;
+} hkos_posix_context_t;
+
+static hkos_posix_context_t* p_contexts;    // every context ever created
+static ucontext_t idle_context;             // context of the idle loop
+static ucontext_t* p_interrupted;           // context the tick interrupted
+static sigset_t tick_mask;
+static uint64_t last_tick;                  // ns
+
+#if HKOS_IRQ_STATS
+/******************************************************************************
+ * Interrupt statistics runtime data
+ *
+ *****************************************************************************/
+static hkos_irq_stats_t irq_stats;
+static uint32_t irq_disabled_start;
+static uintptr_t irq_disabled_site;     // 0 if not being measured
+static uint64_t tick_timer_start;       // ns
+#endif
+
+/******************************************************************************
+ * Helper function to read the monotonic clock
+ *
+ * @return  The time in nanoseconds
+ *
+ *****************************************************************************/
+static inline uint64_t now_ns( void ) {
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+#if HKOS_IRQ_STATS
+/******************************************************************************
+ * Start measuring the time with interrupts disabled
+ *
+ * Must be called after disabling the interrupts
+ *
+ * @param[in]   site        The address of the code disabling them
+ *
+ *****************************************************************************/
+static inline void irq_disabled_begin( uintptr_t site ) {
+    irq_disabled_start = hkos_hal_get_cycles();
+    irq_disabled_site = site;
+}
+
+/******************************************************************************
+ * Finish measuring the time with interrupts disabled
+ *
+ * Must be called before enabling the interrupts
+ *
+ *****************************************************************************/
+static inline void irq_disabled_end( void ) {
+
+    // the interrupts were disabled by an ISR or before HalfKOS started
+    if ( irq_disabled_site == 0 )
+        return;
+
+    uint32_t elapsed = hkos_hal_get_cycles() - irq_disabled_start;
+    if ( elapsed > irq_stats.max_disabled ) {
+        irq_stats.max_disabled = elapsed;
+        irq_stats.max_disabled_site = irq_disabled_site;
+    }
+    irq_disabled_site = 0;
+}
+#endif
+
+/******************************************************************************
+ * Helper function to get the host context of a task
+ *
+ * @param[in]   p_task      The task or NULL for the idle loop
+ *
+ * @return  The context
+ *
+ *****************************************************************************/
+static inline ucontext_t* context_of( hkos_task_t* p_task ) {
+    if ( p_task == NULL )
+        return &idle_context;
+
+    return &( *(hkos_posix_context_t**)p_task->p_sp )->context;
+}
+
+/******************************************************************************
+ * Helper function to resume the running task if it is not the caller
+ *
+ * Must be called with the tick timer interrupt disabled
+ *
+ * @param[in]   p_previous  The task that was running before the scheduler
+ *                          was called
+ *
+ *****************************************************************************/
+static inline void switch_task( hkos_task_t* p_previous ) {
+    hkos_task_t* p_next = hkos_ram.runtime_data.p_running_task;
+
+    if ( p_next != p_previous )
+        swapcontext( context_of( p_previous ), context_of( p_next ) );
+}
+
+/******************************************************************************
+ * Helper function to find or create the host context of a task
+ *
+ * @param[in]   p_top       The stack top of the task in hkos_ram
+ *
+ * @return  The context or NULL if the host is out of memory
+ *
+ *****************************************************************************/
+static hkos_posix_context_t* get_context( void* p_top ) {
+    hkos_posix_context_t* p_context = p_contexts;
+
+    for (; p_context != NULL; p_context = p_context->p_next ) {
+        if ( p_context->p_top == p_top )
+            return p_context;
+    }
+
+    p_context = malloc( sizeof(hkos_posix_context_t) );
+    if ( p_context != NULL ) {
+        p_context->p_stack = malloc( HKOS_POSIX_TASK_STACK );
+        if ( p_context->p_stack == NULL ) {
+            free( p_context );
+            return NULL;
+        }
+        p_context->p_top = p_top;
+        p_context->p_next = p_contexts;
+        p_contexts = p_context;
+    }
+
+    return p_context;
+}
+
+/******************************************************************************
+ * Task entry point
+ *
+ * Starts with the tick timer interrupt disabled, so it can find its context
+ * through the running task. A task function that returns is removed.
+ *
+ *****************************************************************************/
+static void task_entry( void ) {
+    hkos_posix_context_t* p_context = *(hkos_posix_context_t**)
+                                    hkos_ram.runtime_data.p_running_task->p_sp;
+
+    sigprocmask( SIG_UNBLOCK, &tick_mask, NULL );
+    p_context->p_entry( p_context->p_arg );
+    hkos_scheduler_exit_task();
+}
+
+/******************************************************************************
+ * SIGALRM handler. This is the HalfKOS tick timer
+ *
+ * Runs on the stack of the interrupted task. If the scheduler picks another
+ * task, the handler is suspended with the task and finishes when the task
+ * runs again.
+ *
+ *****************************************************************************/
+static void tick_handler( int signal, siginfo_t* p_info, void* p_context ) {
+    int saved_errno = errno;
+    hkos_task_t* p_previous = hkos_ram.runtime_data.p_running_task;
+
+    last_tick = now_ns();
+    p_interrupted = (ucontext_t*)p_context;
+
+#if HKOS_IRQ_STATS
+    // the timer expires at whole periods from its start
+    uint32_t latency = ( last_tick - tick_timer_start ) % TICK_PERIOD_NS;
+    if ( latency > irq_stats.max_latency )
+        irq_stats.max_latency = latency;
+    ++irq_stats.latency_samples;
+#endif
+
+    HKOS_HOOK_ISR_ENTER( TICK_SIGNAL );
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+    hkos_arch_serial_poll();
+#endif
+    hkos_scheduler_tick_timer();
+    HKOS_HOOK_ISR_EXIT( TICK_SIGNAL );
+
+    switch_task( p_previous );
+
+    errno = saved_errno;
+}
+
+/******************************************************************************
+ *  Initialize the HAL and put the system at its initial state
+ *
+ *****************************************************************************/
+void hkos_hal_init( void ) {
+    sigemptyset( &tick_mask );
+    sigaddset( &tick_mask, TICK_SIGNAL );
+
+    struct sigaction action = { 0 };
+    action.sa_sigaction = tick_handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset( &action.sa_mask );
+    sigaction( TICK_SIGNAL, &action, NULL );
+}
+
+/******************************************************************************
+ * Initialize the task stack.
+ *
+ * The task runs on a host stack, so its stack in hkos_ram only holds a
+ * pointer to the host context. The context starts the task in task_entry.
+ *
+ * @param[in]   p_sp        a pointer to the stack pointer indicating the
+ *                          memory region of the task stack
+ * @param[in]   p_pc        a pointer to the beginning of the task code
+ * @param[in]   p_arg       the argument of the task code
+ * @param[in]   stack_size  the size of the task's stack
+ *
+ * @return  The value of stack pointer after the stack initialization or
+ *          NULL if the host is out of memory
+ *
+ *****************************************************************************/
+void* hkos_hal_init_stack( void* p_sp, void* p_pc, void* p_arg,
+                           hkos_size_t stack_size )
+{
+    hkos_posix_context_t* p_context = get_context( p_sp );
+    if ( p_context == NULL )
+        return NULL;
+
+    p_context->p_entry = (void (*)( void* ))p_pc;
+    p_context->p_arg = p_arg;
+
+    getcontext( &p_context->context );
+    p_context->context.uc_stack.ss_sp = p_context->p_stack;
+    p_context->context.uc_stack.ss_size = HKOS_POSIX_TASK_STACK;
+    p_context->context.uc_link = NULL;
+    sigaddset( &p_context->context.uc_sigmask, TICK_SIGNAL );
+    makecontext( &p_context->context, task_entry, 0 );
+
+    hkos_posix_context_t** p_stack = (hkos_posix_context_t**)p_sp;
+    *--p_stack = p_context;
+
+    uint8_t* ret_stack = (uint8_t*)p_stack;
+
+    // The stack in hkos_ram is never used, but it is painted like on the
+    // MCUs, so the stack usage analysis works
+    if ( HKOS_PAINT_TASK_STACK ) {
+        uint8_t* p_paint = ret_stack;
+        stack_size += hkos_hal_get_min_stack_size();
+        while ( p_paint > (uint8_t*)p_sp - stack_size ) {
+            *--p_paint = HKOS_STACK_PAINT_VALUE;
+        }
+    }
+
+    return ret_stack;
+}
+
+/******************************************************************************
+ * Get the minimal stack size
+ *
+ * The stack in hkos_ram only holds the pointer to the host context.
+ *
+ *****************************************************************************/
+hkos_size_t hkos_hal_get_min_stack_size( void ) {
+    return sizeof(hkos_posix_context_t*);
+}
+
+/******************************************************************************
+ * Jump to the operating system
+ *
+ * Starts the tick timer and turns main into the idle loop. The idle loop
+ * waits for signals, like the MCU sleeping in a low power mode.
+ *
+ *****************************************************************************/
+void hkos_hal_jump_to_os( void ) {
+
+    // We paint the OS stack to help debug
+    if ( HKOS_PAINT_TASK_STACK ) {
+        for ( hkos_size_t i = 0; i < arraysize(hkos_ram.os_stack); ++i ) {
+            hkos_ram.os_stack[i] = HKOS_STACK_PAINT_VALUE;
+        }
+    }
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = TICK_PERIOD_NS / 1000;
+    timer.it_value = timer.it_interval;
+
+    last_tick = now_ns();
+#if HKOS_IRQ_STATS
+    tick_timer_start = last_tick;
+#endif
+    setitimer( ITIMER_REAL, &timer, NULL );
+
+    sigset_t wait_mask;
+    sigemptyset( &wait_mask );
+    sigprocmask( SIG_UNBLOCK, &tick_mask, NULL );
+
+    while ( 1 ) {
+#if !HKOS_PREEMPTION
+        // without preemption, the idle loop yields to the ready tasks
+        hkos_scheduler_yield();
+#endif
+        sigsuspend( &wait_mask );
+    }
+}
+
+/******************************************************************************
+ * Yield the CPU to the next task
+ *
+ * The context of the caller is saved by swapcontext, so this returns when
+ * the caller runs again.
+ *
+ *****************************************************************************/
+void hkos_hal_yield( void ) {
+    sigset_t previous;
+    sigprocmask( SIG_BLOCK, &tick_mask, &previous );
+
+    hkos_task_t* p_previous = hkos_ram.runtime_data.p_running_task;
+    hkos_scheduler_switch_context();
+    switch_task( p_previous );
+
+    sigprocmask( SIG_SETMASK, &previous, NULL );
+}
+
+/******************************************************************************
+ * Enter Critical Section
+ *
+ * Blocks the tick timer signal
+ *
+ * OBS: this function must not be called by user code, because it may affect
+ * the time counting. All use of this function MUST be restricted to HalfKOS
+ * core.
+ *
+ *****************************************************************************/
+void hkos_hal_enter_critical_section( void ) {
+#if HKOS_IRQ_STATS
+    sigset_t previous;
+    sigprocmask( SIG_BLOCK, &tick_mask, &previous );
+    if ( !sigismember( &previous, TICK_SIGNAL ) )
+        irq_disabled_begin( (uintptr_t)__builtin_return_address(0) );
+#else
+    sigprocmask( SIG_BLOCK, &tick_mask, NULL );
+#endif
+}
+
+/******************************************************************************
+ * Exit Critical Section
+ *
+ * Unblocks the tick timer signal
+ *
+ * OBS: this function must not be called by user code, because it may affect
+ * the time counting. All use of this function MUST be restricted to HalfKOS
+ * core.
+ *
+ *****************************************************************************/
+void hkos_hal_exit_critical_section( void ) {
+#if HKOS_IRQ_STATS
+    irq_disabled_end();
+#endif
+    sigprocmask( SIG_UNBLOCK, &tick_mask, NULL );
+}
+
+/******************************************************************************
+ * Save the interrupt state and disable interrupts
+ *
+ * @return  True if the tick timer signal was not blocked
+ *
+ *****************************************************************************/
+hkos_irq_state_t hkos_hal_irq_save( void ) {
+    sigset_t previous;
+    sigprocmask( SIG_BLOCK, &tick_mask, &previous );
+
+    hkos_irq_state_t state = !sigismember( &previous, TICK_SIGNAL );
+#if HKOS_IRQ_STATS
+    if ( state )
+        irq_disabled_begin( (uintptr_t)__builtin_return_address(0) );
+#endif
+    return state;
+}
+
+/******************************************************************************
+ * Restore the interrupt state saved by hkos_hal_irq_save
+ *
+ * @param[in]   state       The state returned by hkos_hal_irq_save
+ *
+ *****************************************************************************/
+void hkos_hal_irq_restore( hkos_irq_state_t state ) {
+    if ( state ) {
+#if HKOS_IRQ_STATS
+        irq_disabled_end();
+#endif
+        sigprocmask( SIG_UNBLOCK, &tick_mask, NULL );
+    }
+}
+
+/******************************************************************************
+ * Get the time elapsed since the last tick
+ *
+ * If the tick timer signal is late, the result keeps growing past a tick,
+ * up to two ticks.
+ *
+ * @return  Time since the last tick in microseconds
+ *
+ *****************************************************************************/
+uint16_t hkos_hal_get_tick_fraction( void ) {
+    uint64_t fraction = ( now_ns() - last_tick ) / 1000;
+
+    if ( fraction >= 2 * HKOS_HAL_TICK_FRACTIONS )
+        fraction = 2 * HKOS_HAL_TICK_FRACTIONS - 1;
+
+    return (uint16_t)fraction;
+}
+
+/******************************************************************************
+ * Get the cycle counter
+ *
+ * The host has no portable cycle counter, so this counts nanoseconds.
+ *
+ * @return  The monotonic clock in nanoseconds
+ *
+ *****************************************************************************/
+uint32_t hkos_hal_get_cycles( void ) {
+    return (uint32_t)now_ns();
+}
+
+#if HKOS_IRQ_STATS
+/******************************************************************************
+ * Get the interrupt statistics
+ *
+ * Times are in nanoseconds. The latency is how long after the expiry of the
+ * interval timer the tick timer signal is handled.
+ *
+ * @param[out]  p_stats     The statistics
+ *
+ *****************************************************************************/
+void hkos_hal_get_irq_stats( hkos_irq_stats_t* p_stats ) {
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    *p_stats = irq_stats;
+    hkos_hal_irq_restore( state );
+}
+
+/******************************************************************************
+ * Discard the interrupt statistics
+ *
+ *****************************************************************************/
+void hkos_hal_reset_irq_stats( void ) {
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    irq_stats = (hkos_irq_stats_t){ 0, 0, 0, 0 };
+    hkos_hal_irq_restore( state );
+}
+#endif
+
+/******************************************************************************
+ * Get the program counter saved in the context of a task
+ *
+ * Only the running task is sampled, so this is the program counter the
+ * kernel saved when it delivered the tick timer signal.
+ *
+ * @param[in]   p_sp        The stack pointer saved in the task structure
+ *
+ * @return  The address the task was executing when it was interrupted
+ *
+ *****************************************************************************/
+uintptr_t hkos_hal_get_saved_pc( void* p_sp ) {
+#if defined(__x86_64__)
+    return (uintptr_t)p_interrupted->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+    return (uintptr_t)p_interrupted->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+    return (uintptr_t)p_interrupted->uc_mcontext.pc;
+#else
+    return 0;
+#endif
+}
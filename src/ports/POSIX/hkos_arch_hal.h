@@ -0,0 +1,53 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+#ifndef __HKOS_ARCH_HAL_H
+#define __HKOS_ARCH_HAL_H
+
+#include <inttypes.h>
+
+#define HKOS_HAL_TICKS_IN_A_SECOND              1000
+
+// Tick fractions are microseconds
+#define HKOS_HAL_TICK_FRACTIONS                 ( 1000000 / HKOS_HAL_TICKS_IN_A_SECOND )
+
+// Contexts are switched with ucontext, so there are no naked functions
+#define HKOS_HAL_HAS_YIELD                      1
+
+// Pointers are 4 times wider than on MSP430
+#define HKOS_HAL_RAM_SCALE                      4
+
+// Each task runs on a stack allocated from the host. The memory block
+// of the task only holds a pointer to it.
+#ifndef HKOS_POSIX_TASK_STACK
+#define HKOS_POSIX_TASK_STACK                   ( 64 * 1024 )
+#endif
+
+// Configure the data type of the dynamic memory
+// allocation block header. It must be as wide as a pointer,
+// so the memory handed out by the allocator is aligned.
+typedef uint64_t                    hkos_dmem_header_t;
+
+// Data type used to save the interrupt state (true if the tick was enabled)
+typedef int                         hkos_irq_state_t;
+
+#endif // __HKOS_ARCH_HAL_H
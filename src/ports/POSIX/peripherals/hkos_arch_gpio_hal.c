@@ -0,0 +1,172 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/**************************************************************************
+ *
+ * HalfKOS GPIO implementation for POSIX hosts
+ *
+ * The pins are kept in memory. Changes of the outputs are logged to
+ * stderr, or to the file named by the environment variable HKOS_GPIO_LOG,
+ * one line per change: "<ms> <pin> <value>".
+ *
+ * ************************************************************************/
+#include <core/hkos_hal.h>
+#include <core/hkos_scheduler.h>
+#include <core/peripherals/gpio/hkos_gpio_hal.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// General Macros
+//
+#define arraysize(x)    (sizeof(x) / sizeof(x[0]))
+
+// Pins are numbered from 0 to HKOS_POSIX_GPIO_PINS - 1
+#ifndef HKOS_POSIX_GPIO_PINS
+#define HKOS_POSIX_GPIO_PINS    32
+#endif
+
+/******************************************************************************
+ * State of a GPIO pin
+ *
+ *****************************************************************************/
+typedef struct {
+    hkos_gpio_pin_mode_t    mode;
+    hkos_gpio_value_t       value;
+} hkos_posix_gpio_t;
+
+static hkos_posix_gpio_t gpio_pins[HKOS_POSIX_GPIO_PINS];
+static int log_fd = -1;
+
+/******************************************************************************
+ * Helper function to log the change of a pin
+ *
+ * @param[in]   pin     pin number
+ *
+ *****************************************************************************/
+static void log_pin( uint8_t pin ) {
+
+    if ( log_fd < 0 ) {
+        const char* p_path = getenv( "HKOS_GPIO_LOG" );
+        log_fd = ( p_path == NULL ) ? STDERR_FILENO
+                    : open( p_path, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    }
+
+    char line[48];
+    int size = snprintf( line, sizeof(line), "%lu %u %s\n",
+                         (unsigned long)HKOS_TICKS_TO_MS( hkos_scheduler_get_ticks() ),
+                         pin, gpio_pins[pin].value == HIGH ? "HIGH" : "LOW" );
+
+    if ( log_fd >= 0 && size > 0 )
+        (void)!write( log_fd, line, size );
+}
+
+/******************************************************************************
+ * Helper function to change the value of a pin
+ *
+ * The value is stored even if the pin is an input, so it is the output
+ * value when the pin becomes an output.
+ *
+ * @param[in]   pin     pin number
+ * @param[in]   value   the new value
+ *
+ *****************************************************************************/
+static void set_pin( uint8_t pin, hkos_gpio_value_t value ) {
+    hkos_irq_state_t state = hkos_hal_irq_save();
+
+    bool changed = gpio_pins[pin].value != value;
+    gpio_pins[pin].value = value;
+
+    if ( changed && gpio_pins[pin].mode == OUTPUT )
+        log_pin( pin );
+
+    hkos_hal_irq_restore( state );
+}
+
+/******************************************************************************
+ * Configure a GPIO pin
+ *
+ * An input pin reads its pull, or LOW if it has none.
+ *
+ * @param[in]   pin     pin number
+ * @param[in]   mode    the mode selected from the pin mode enumeration
+ *
+ *****************************************************************************/
+void hkos_gpio_config( uint8_t pin, hkos_gpio_pin_mode_t mode )
+{
+    if ( pin >= arraysize(gpio_pins) )
+        return;
+
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    gpio_pins[pin].mode = mode;
+
+    if ( mode == OUTPUT ) {
+        log_pin( pin );
+    } else {
+        gpio_pins[pin].value = ( mode == INPUT_PULLUP ) ? HIGH : LOW;
+    }
+    hkos_hal_irq_restore( state );
+}
+
+/******************************************************************************
+ * Write a value to a GPIO pin
+ *
+ * @param[in]   pin     pin number
+ * @param[in]   value   the value selected from the pin value enumeration
+ *
+ *****************************************************************************/
+void hkos_gpio_write( uint8_t pin, hkos_gpio_value_t value )
+{
+    if ( pin < arraysize(gpio_pins) )
+        set_pin( pin, value );
+}
+
+/******************************************************************************
+ * Toggle the value of a GPIO pin
+ *
+ * @param[in]   pin     pin number
+ *
+ *****************************************************************************/
+void hkos_gpio_toggle( uint8_t pin )
+{
+    if ( pin < arraysize(gpio_pins) )
+        set_pin( pin, gpio_pins[pin].value == HIGH ? LOW : HIGH );
+}
+
+/******************************************************************************
+ * Read the value of a GPIO pin
+ *
+ * @param[in]   pin     pin number
+ *
+ * @return  The value of the GPIO pin taken from the pin value enumeration
+ *
+ *****************************************************************************/
+hkos_gpio_value_t hkos_gpio_read( uint8_t pin )
+{
+    if ( pin >= arraysize(gpio_pins) )
+        return LOW;
+
+    return gpio_pins[pin].value;
+}
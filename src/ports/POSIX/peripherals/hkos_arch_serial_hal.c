@@ -0,0 +1,250 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/**************************************************************************
+ *
+ * HalfKOS serial port implementation for POSIX hosts
+ *
+ * The environment variable HKOS_SERIAL<n> selects what serial port n is:
+ *
+ *      - not set: stdin and stdout (port 0 only)
+ *      - "pty": a new pseudo-terminal, whose name is printed to stderr
+ *      - anything else: the path of a file or device
+ *
+ * The line settings are ignored.
+ *
+ * ************************************************************************/
+#define _GNU_SOURCE
+#include <hkos_errors.h>
+#include <core/hkos_hal.h>
+#include <core/hkos_scheduler.h>
+#include <core/peripherals/serial/hkos_serial_hal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Serial port interface is only enabled when there are serial ports enabled
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+
+#if HKOS_SERIAL_PORTS_ENABLE > 10
+#error POSIX port supports up to 10 serial ports.
+#endif
+
+extern hkos_serial_ring_buffer hkos_serial_rx_buffer[HKOS_SERIAL_PORTS_ENABLE];
+extern hkos_serial_ring_buffer hkos_serial_tx_buffer[HKOS_SERIAL_PORTS_ENABLE];
+
+/******************************************************************************
+ * File descriptors of the serial ports, -1 when closed
+ *
+ *****************************************************************************/
+typedef struct {
+    int     fd_in;
+    int     fd_out;
+} hkos_posix_serial_t;
+
+static hkos_posix_serial_t serial_ports[HKOS_SERIAL_PORTS_ENABLE] = {
+    [ 0 ... HKOS_SERIAL_PORTS_ENABLE - 1 ] = { -1, -1 }
+};
+
+/**************************************************************************
+ * Helper function to open a pseudo-terminal
+ *
+ * @param[in]       port            Port number
+ *
+ * @return      The file descriptor of the master side or -1
+ *
+ * ************************************************************************/
+static int open_pty( uint8_t port )
+{
+    int fd = posix_openpt( O_RDWR | O_NOCTTY );
+
+    if ( fd >= 0 ) {
+        if ( grantpt( fd ) != 0 || unlockpt( fd ) != 0 ) {
+            close( fd );
+            return -1;
+        }
+
+        // nobody may be listening, so data is lost instead of blocking
+        fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+        fprintf( stderr, "HalfKOS: serial port %u is %s\n", port, ptsname( fd ) );
+    }
+
+    return fd;
+}
+
+/**************************************************************************
+ * Open a serial port
+ *
+ * @param[in]       port            Port number
+ * @param[in]       baud            Baud rate
+ * @param[in]       data_bits       Number of data bits
+ * @param[in]       stop_bits       Number of stop bits
+ * @param[in]       parity          Parity
+ *
+ * @return      HKOS_ERROR_NONE or error code
+ *
+ * ************************************************************************/
+hkos_error_code_t hkos_arch_serial_open(    uint8_t port,
+                                            uint32_t baud,
+                                            hkos_serial_data_bits_t data_bits,
+                                            hkos_serial_stop_bits_t stop_bits,
+                                            hkos_serial_parity_t parity )
+{
+    if ( port >= HKOS_SERIAL_PORTS_ENABLE )
+        return HKOS_ERROR_INVALID_RESOURCE;
+
+    if ( serial_ports[port].fd_out >= 0 )
+        return HKOS_ERROR_RESOURCE_BUSY;
+
+    char name[] = "HKOS_SERIAL0";
+    name[ sizeof(name) - 2 ] += port;
+    const char* p_path = getenv( name );
+
+    int fd_in = -1;
+    int fd_out = -1;
+
+    if ( p_path == NULL ) {
+        if ( port == 0 ) {
+            fd_in = STDIN_FILENO;
+            fd_out = STDOUT_FILENO;
+        }
+    } else if ( strcmp( p_path, "pty" ) == 0 ) {
+        fd_in = fd_out = open_pty( port );
+    } else {
+        fd_in = fd_out = open( p_path, O_RDWR | O_CREAT | O_NOCTTY, 0644 );
+    }
+
+    if ( fd_out < 0 )
+        return HKOS_ERROR_INVALID_RESOURCE;
+
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    serial_ports[port].fd_in = fd_in;
+    serial_ports[port].fd_out = fd_out;
+    hkos_hal_irq_restore( state );
+
+    return HKOS_ERROR_NONE;
+}
+
+
+/**************************************************************************
+ * Closes a serial port
+ *
+ * @param[in]       port            Port number
+ *
+ * @return      HKOS_ERROR_NONE or error code
+ *
+ * ************************************************************************/
+hkos_error_code_t hkos_arch_serial_close( uint8_t port )
+{
+    // the tx buffer is always empty, because writes are done right away
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    int fd = serial_ports[port].fd_out;
+    serial_ports[port].fd_in = -1;
+    serial_ports[port].fd_out = -1;
+
+    // discard all data in the rx buffer
+    hkos_serial_rx_buffer[port].head = hkos_serial_rx_buffer[port].tail;
+    hkos_hal_irq_restore( state );
+
+    if ( fd > STDERR_FILENO )
+        close( fd );
+
+    return HKOS_ERROR_NONE;
+}
+
+
+/**************************************************************************
+ * Signals that there is pending data in the tx buffer
+ *
+ * Writes the whole tx buffer to the port.
+ *
+ * @param[in]       port            Port number
+ *
+ * @return      HKOS_ERROR_NONE or error code
+ *
+ * ************************************************************************/
+hkos_error_code_t hkos_arch_serial_tx_pending( uint8_t port )
+{
+    hkos_serial_ring_buffer* p_tx = &hkos_serial_tx_buffer[port];
+    hkos_irq_state_t state = hkos_hal_irq_save();
+
+    while ( p_tx->head != p_tx->tail ) {
+        uint8_t end = ( p_tx->head > p_tx->tail ) ? p_tx->head
+                                                  : HKOS_SERIAL_BUFFER_SIZE;
+        ssize_t written = -1;
+
+        if ( serial_ports[port].fd_out >= 0 )
+            written = write( serial_ports[port].fd_out,
+                             &p_tx->buffer[p_tx->tail], end - p_tx->tail );
+
+        // data that cannot be written is lost, like on a disconnected line
+        if ( written <= 0 )
+            written = end - p_tx->tail;
+
+        p_tx->tail = ( p_tx->tail + written ) % HKOS_SERIAL_BUFFER_SIZE;
+    }
+
+    hkos_hal_irq_restore( state );
+    return HKOS_ERROR_NONE;
+}
+
+
+/**************************************************************************
+ * Poll the receivers
+ *
+ * Called by the tick timer interrupt, so it is part of its trace. Reads
+ * what fits in the rx buffers and signals the waiting tasks, like the RX
+ * interrupt of the MCUs.
+ *
+ * ************************************************************************/
+void hkos_arch_serial_poll( void )
+{
+    for ( uint8_t port = 0; port < HKOS_SERIAL_PORTS_ENABLE; ++port ) {
+        hkos_serial_ring_buffer* p_rx = &hkos_serial_rx_buffer[port];
+        struct pollfd fd = { serial_ports[port].fd_in, POLLIN, 0 };
+
+        if ( fd.fd < 0 || poll( &fd, 1, 0 ) <= 0 || !( fd.revents & POLLIN ) )
+            continue;
+
+        // Check if there is space before adding each character
+        uint8_t i;
+        while ( ( i = ( p_rx->head + 1 ) % HKOS_SERIAL_BUFFER_SIZE ) != p_rx->tail ) {
+            char c;
+            if ( read( fd.fd, &c, 1 ) != 1 )
+                break;
+
+            p_rx->buffer[p_rx->head] = c;
+            p_rx->head = i;
+            hkos_serial_signal_waiting_tasks( port );
+
+            if ( poll( &fd, 1, 0 ) <= 0 || !( fd.revents & POLLIN ) )
+                break;
+        }
+    }
+}
+
+#endif// HKOS_SERIAL_PORTS_ENABLE > 0
@@ -0,0 +1,967 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/**************************************************************************
+ *
+ * HalfKOS Hardware Abstraction Layer implementation for the virtual time
+ * simulator
+ *
+ * HalfKOS runs in a single process and thread, with no signals:
+ *
+ *      - each task runs on its own host stack and contexts are switched
+ *        with ucontext
+ *      - the idle loop runs on the stack of main
+ *      - the virtual clock only advances in advance_time, where the due
+ *        ticks and script events are served as interrupts
+ *      - disabling interrupts is clearing irq_enabled, which makes the
+ *        events wait until the interrupts are enabled again
+ *
+ * With HKOS_MULTI_INSTANCE, each instance runs like that on its own host
+ * thread, with its own copy of this state. Every HKOS_SIM_LINK_LATENCY of
+ * virtual time, the instances wait for each other and exchange the data of
+ * the serial lines.
+ *
+ * See hkos_sim.h for the script format.
+ *
+ * ************************************************************************/
+#define _GNU_SOURCE
+#include <core/hkos_hal.h>
+#include <core/hkos_scheduler.h>
+#include <core/hkos_hooks.h>
+#include <core/peripherals/gpio/hkos_gpio_hal.h>
+#include <core/peripherals/serial/hkos_serial_hal.h>
+#include <hkos_sim.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+#if HKOS_MULTI_INSTANCE
+#include <hkos.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#endif
+
+// General Macros
+//
+#define arraysize(x)    (sizeof(x) / sizeof(x[0]))
+
+// Tick period in nanoseconds
+#define TICK_PERIOD_NS  ( 1000000000L / HKOS_HAL_TICKS_IN_A_SECOND )
+
+// Vector number of the tick timer in the trace. Script irq events use
+// their own numbers.
+#define TICK_VECTOR     0xFF
+
+// No event pending
+#define NEVER           UINT64_MAX
+
+// Peripherals driven by the script
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+extern void hkos_sim_serial_receive( uint8_t port, const char* p_data,
+                                     size_t size );
+#endif
+extern void hkos_sim_gpio_input( uint8_t pin, hkos_gpio_value_t value );
+
+#if HKOS_MULTI_INSTANCE && HKOS_SERIAL_PORTS_ENABLE > 0
+// Serial lines between the instances
+extern void hkos_sim_serial_sync( uint32_t quantum );
+extern uint64_t hkos_sim_serial_next_rx( void );
+extern void hkos_sim_serial_deliver( void );
+#endif
+
+/******************************************************************************
+ * Host context of a task
+ *
+ * Contexts are never freed. They belong to the memory block of a task and
+ * are reused by the next task whose stack starts at the same address.
+ *
+ *****************************************************************************/
+typedef struct hkos_sim_context_t {
+    ucontext_t                      context;
+    void*                           p_top;      // stack top in hkos_ram
+    void                            (*p_entry)( void* );
+    void*                           p_arg;
+    uint8_t*                        p_stack;    // host stack
+    struct hkos_sim_context_t*      p_next;
+} hkos_sim_context_t;
+
+/******************************************************************************
+ * Script events
+ *
+ *****************************************************************************/
+typedef enum {
+    EVENT_SERIAL,
+    EVENT_GPIO,
+    EVENT_IRQ,
+    EVENT_END,
+} hkos_sim_event_type_t;
+
+typedef struct {
+    uint64_t                time;       // ns, NEVER if there are no more
+    hkos_sim_event_type_t   type;
+    uint32_t                number;     // port, pin or irq
+    uint32_t                arg;        // value, irq argument or exit code
+    char                    text[128];
+} hkos_sim_event_t;
+
+static HKOS_INSTANCE_LOCAL hkos_sim_context_t* p_contexts; // every context ever created
+static HKOS_INSTANCE_LOCAL ucontext_t idle_context;      // context of the idle loop
+
+static HKOS_INSTANCE_LOCAL uint64_t sim_now;             // ns
+static HKOS_INSTANCE_LOCAL uint64_t last_tick;
+static HKOS_INSTANCE_LOCAL uint64_t next_tick;           // NEVER before hkos_hal_jump_to_os
+static HKOS_INSTANCE_LOCAL bool irq_enabled;
+static HKOS_INSTANCE_LOCAL uintptr_t interrupted_pc;     // where the last interrupt hit
+
+static HKOS_INSTANCE_LOCAL FILE* p_script;
+static HKOS_INSTANCE_LOCAL unsigned script_line;
+static HKOS_INSTANCE_LOCAL hkos_sim_event_t next_event;
+
+#if HKOS_MULTI_INSTANCE
+/******************************************************************************
+ * Instances
+ *
+ * The instances are added by instance 0 before HalfKOS starts, so only
+ * the synchronization needs locking.
+ *
+ *****************************************************************************/
+static void (**p_setups)( void );       // by instance, unused for 0
+static unsigned instance_count = 1;
+static pthread_barrier_t sync_barrier;
+static sem_t workers;                   // free worker slots
+static int end_code = -1;               // set by the end event
+
+static HKOS_INSTANCE_LOCAL unsigned instance_id;
+static HKOS_INSTANCE_LOCAL uint64_t next_sync;          // NEVER before hkos_hal_jump_to_os
+static HKOS_INSTANCE_LOCAL uint32_t quantum;            // synchronizations done
+#endif
+
+#if HKOS_IRQ_STATS
+/******************************************************************************
+ * Interrupt statistics runtime data
+ *
+ *****************************************************************************/
+static HKOS_INSTANCE_LOCAL hkos_irq_stats_t irq_stats;
+static HKOS_INSTANCE_LOCAL uint32_t irq_disabled_start;
+static HKOS_INSTANCE_LOCAL uintptr_t irq_disabled_site;  // 0 if not being measured
+
+/******************************************************************************
+ * Start measuring the time with interrupts disabled
+ *
+ * Must be called after disabling the interrupts
+ *
+ * @param[in]   site        The address of the code disabling them
+ *
+ *****************************************************************************/
+static inline void irq_disabled_begin( uintptr_t site ) {
+    irq_disabled_start = hkos_hal_get_cycles();
+    irq_disabled_site = site;
+}
+
+/******************************************************************************
+ * Finish measuring the time with interrupts disabled
+ *
+ * Must be called before enabling the interrupts
+ *
+ *****************************************************************************/
+static inline void irq_disabled_end( void ) {
+
+    // the interrupts were disabled by an ISR or before HalfKOS started
+    if ( irq_disabled_site == 0 )
+        return;
+
+    uint32_t elapsed = hkos_hal_get_cycles() - irq_disabled_start;
+    if ( elapsed > irq_stats.max_disabled ) {
+        irq_stats.max_disabled = elapsed;
+        irq_stats.max_disabled_site = irq_disabled_site;
+    }
+    irq_disabled_site = 0;
+}
+#endif
+
+/******************************************************************************
+ * Helper function to stop the simulation because of a bad script
+ *
+ * @param[in]   p_reason    What is wrong
+ *
+ *****************************************************************************/
+static void script_error( const char* p_reason ) {
+    fprintf( stderr, "HalfKOS: script line %u: %s\n", script_line, p_reason );
+    exit( 2 );
+}
+
+/******************************************************************************
+ * Helper function to decode the escapes of the text of a serial event
+ *
+ * @param[inout]    p_text      The text, decoded in place
+ *
+ *****************************************************************************/
+static void unescape( char* p_text ) {
+    char* p_out = p_text;
+
+    for (; *p_text != '\0'; ++p_text ) {
+        if ( *p_text == '\\' && p_text[1] != '\0' ) {
+            ++p_text;
+            *p_out++ = ( *p_text == 'n' ) ? '\n' :
+                       ( *p_text == 'r' ) ? '\r' : *p_text;
+        } else {
+            *p_out++ = *p_text;
+        }
+    }
+    *p_out = '\0';
+}
+
+/******************************************************************************
+ * Helper function to read the next event of the script
+ *
+ *****************************************************************************/
+static void read_next_event( void ) {
+    uint64_t previous = next_event.time;
+    char line[256];
+
+    next_event.time = NEVER;
+
+    while ( p_script != NULL && fgets( line, sizeof(line), p_script ) != NULL ) {
+        ++script_line;
+
+        unsigned long long time_us;
+        char type[16];
+        int used;
+
+        if ( sscanf( line, " %llu %15s %n", &time_us, type, &used ) < 2 ) {
+            char first[2];
+            if ( sscanf( line, " %1s", first ) < 1 || first[0] == '#' )
+                continue;
+            script_error( "expected <time in us> <event>" );
+        }
+
+        char* p_args = line + used;
+        next_event.number = 0;
+        next_event.arg = 0;
+        next_event.text[0] = '\0';
+
+        if ( strcmp( type, "serial" ) == 0 ) {
+            next_event.type = EVENT_SERIAL;
+            if ( sscanf( p_args, "%u %127[^\n]", &next_event.number,
+                         next_event.text ) < 2 )
+                script_error( "expected serial <port> <text>" );
+            unescape( next_event.text );
+        } else if ( strcmp( type, "gpio" ) == 0 ) {
+            next_event.type = EVENT_GPIO;
+            if ( sscanf( p_args, "%u %u", &next_event.number,
+                         &next_event.arg ) < 2 )
+                script_error( "expected gpio <pin> <0|1>" );
+        } else if ( strcmp( type, "irq" ) == 0 ) {
+            next_event.type = EVENT_IRQ;
+            if ( sscanf( p_args, "%u %u", &next_event.number,
+                         &next_event.arg ) < 1 )
+                script_error( "expected irq <number> [arg]" );
+        } else if ( strcmp( type, "end" ) == 0 ) {
+            next_event.type = EVENT_END;
+            sscanf( p_args, "%u", &next_event.arg );
+        } else {
+            script_error( "unknown event" );
+        }
+
+        next_event.time = time_us * 1000;
+        if ( previous != NEVER && next_event.time < previous )
+            script_error( "events out of order" );
+        return;
+    }
+}
+
+#if HKOS_MULTI_INSTANCE
+/******************************************************************************
+ * Helper function to end the simulation of all instances
+ *
+ * Called by every instance in the same synchronization. The others stop
+ * before the process exits, so the output is complete.
+ *
+ *****************************************************************************/
+static void end_simulation( void ) {
+    if ( pthread_barrier_wait( &sync_barrier ) == PTHREAD_BARRIER_SERIAL_THREAD )
+        exit( end_code );
+
+    while ( 1 ) {
+        pause();
+    }
+}
+
+/******************************************************************************
+ * Helper function to wait for the other instances at the end of a quantum
+ *
+ * The worker slot is given up while waiting. Then, the data the other
+ * instances transmitted in the quantum is received.
+ *
+ *****************************************************************************/
+static void sync_instances( void ) {
+    sem_post( &workers );
+    pthread_barrier_wait( &sync_barrier );
+
+    if ( end_code >= 0 )
+        end_simulation();
+
+    sem_wait( &workers );
+    ++quantum;
+    next_sync += HKOS_SIM_LINK_LATENCY;
+
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+    hkos_sim_serial_sync( quantum );
+#endif
+}
+
+/******************************************************************************
+ * Entry point of the threads of the instances
+ *
+ * @param[in]   p_arg       The instance number
+ *
+ *****************************************************************************/
+static void* instance_main( void* p_arg ) {
+    instance_id = (unsigned)(uintptr_t)p_arg;
+
+    hkos_init();
+    p_setups[instance_id]();
+    hkos_start();
+
+    return NULL;
+}
+
+/******************************************************************************
+ * Helper function to start the threads of the other instances
+ *
+ * Called by instance 0 when HalfKOS starts
+ *
+ *****************************************************************************/
+static void start_instances( void ) {
+    const char* p_workers = getenv( "HKOS_SIM_WORKERS" );
+    long count = ( p_workers != NULL ) ? atol( p_workers )
+                                       : sysconf( _SC_NPROCESSORS_ONLN );
+    if ( count < 1 )
+        count = 1;
+
+    sem_init( &workers, 0, (unsigned)count );
+    pthread_barrier_init( &sync_barrier, NULL, instance_count );
+
+    pthread_attr_t attr;
+    pthread_attr_init( &attr );
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+
+    for ( unsigned i = 1; i < instance_count; ++i ) {
+        pthread_t thread;
+        if ( pthread_create( &thread, &attr, instance_main,
+                             (void*)(uintptr_t)i ) != 0 ) {
+            fprintf( stderr, "HalfKOS: cannot start instance %u\n", i );
+            exit( 2 );
+        }
+    }
+    pthread_attr_destroy( &attr );
+}
+#endif
+
+/******************************************************************************
+ * Helper function to serve a script event
+ *
+ * Called as an interrupt
+ *
+ *****************************************************************************/
+static void run_script_event( void ) {
+    switch ( next_event.type ) {
+    case EVENT_SERIAL:
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+        if ( next_event.number < HKOS_SERIAL_PORTS_ENABLE )
+            hkos_sim_serial_receive( next_event.number, next_event.text,
+                                     strlen( next_event.text ) );
+#endif
+        break;
+    case EVENT_GPIO:
+        hkos_sim_gpio_input( next_event.number,
+                             next_event.arg ? HIGH : LOW );
+        break;
+    case EVENT_IRQ:
+        HKOS_HOOK_ISR_ENTER( next_event.number );
+        hkos_sim_irq_hook( next_event.number, next_event.arg );
+        HKOS_HOOK_ISR_EXIT( next_event.number );
+        break;
+    case EVENT_END:
+        fprintf( stderr, "HalfKOS: simulation ended at %llu us\n",
+                 (unsigned long long)( sim_now / 1000 ) );
+#if HKOS_MULTI_INSTANCE
+        // the other instances stop at the end of their quantum
+        end_code = next_event.arg;
+        sync_instances();
+#endif
+        exit( next_event.arg );
+    }
+}
+
+/******************************************************************************
+ * Helper function to get the host context of a task
+ *
+ * @param[in]   p_task      The task or NULL for the idle loop
+ *
+ * @return  The context
+ *
+ *****************************************************************************/
+static inline ucontext_t* context_of( hkos_task_t* p_task ) {
+    if ( p_task == NULL )
+        return &idle_context;
+
+    return &( *(hkos_sim_context_t**)p_task->p_sp )->context;
+}
+
+/******************************************************************************
+ * Helper function to resume the running task if it is not the caller
+ *
+ * Must be called with interrupts disabled
+ *
+ * @param[in]   p_previous  The task that was running before the scheduler
+ *                          was called
+ *
+ *****************************************************************************/
+static inline void switch_task( hkos_task_t* p_previous ) {
+    hkos_task_t* p_next = hkos_ram.runtime_data.p_running_task;
+
+    if ( p_next != p_previous ) {
+        sim_now += HKOS_SIM_SWITCH_COST;
+        swapcontext( context_of( p_previous ), context_of( p_next ) );
+    }
+}
+
+/******************************************************************************
+ * Helper function to get the time of the next interrupt
+ *
+ * With HKOS_MULTI_INSTANCE, the synchronizations and the data received from
+ * the serial lines count as interrupts too.
+ *
+ * @return  The time of the next tick or script event, whichever is first
+ *
+ *****************************************************************************/
+static inline uint64_t next_interrupt( void ) {
+    uint64_t next = ( next_event.time < next_tick ) ? next_event.time : next_tick;
+
+#if HKOS_MULTI_INSTANCE
+    if ( next_sync < next )
+        next = next_sync;
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+    uint64_t rx = hkos_sim_serial_next_rx();
+    if ( rx < next )
+        next = rx;
+#endif
+#endif
+
+    return next;
+}
+
+/******************************************************************************
+ * Helper function to serve the interrupts due now
+ *
+ * Must be called with interrupts enabled. A tick may switch to another
+ * task, in which case this returns when the caller runs again.
+ *
+ * @param[in]   pc          Where the caller was interrupted
+ *
+ *****************************************************************************/
+static void serve_interrupts( uintptr_t pc ) {
+    uint64_t time;
+
+    while ( ( time = next_interrupt() ) <= sim_now ) {
+        hkos_task_t* p_previous = hkos_ram.runtime_data.p_running_task;
+
+#if HKOS_MULTI_INSTANCE
+        // waiting for the other instances is not an interrupt
+        if ( time == next_sync && time != next_tick ) {
+            sync_instances();
+            continue;
+        }
+#endif
+
+        irq_enabled = false;
+        interrupted_pc = pc;
+
+#if HKOS_IRQ_STATS
+        uint32_t latency = (uint32_t)( sim_now - time );
+        if ( latency > irq_stats.max_latency )
+            irq_stats.max_latency = latency;
+        ++irq_stats.latency_samples;
+#endif
+
+        // on a tie, the tick comes first
+        if ( time == next_tick ) {
+            last_tick = next_tick;
+            next_tick += TICK_PERIOD_NS;
+
+            HKOS_HOOK_ISR_ENTER( TICK_VECTOR );
+            hkos_scheduler_tick_timer();
+            HKOS_HOOK_ISR_EXIT( TICK_VECTOR );
+        } else if ( time == next_event.time ) {
+            run_script_event();
+            read_next_event();
+        }
+#if HKOS_MULTI_INSTANCE && HKOS_SERIAL_PORTS_ENABLE > 0
+        else {
+            hkos_sim_serial_deliver();
+        }
+#endif
+
+        sim_now += HKOS_SIM_ISR_COST;
+        switch_task( p_previous );
+        irq_enabled = true;
+    }
+}
+
+/******************************************************************************
+ * Helper function to advance the virtual clock
+ *
+ * With interrupts enabled, the interrupts due in the meantime are served
+ * and the time spent in other tasks does not count.
+ *
+ * @param[in]   ns          Time to advance
+ * @param[in]   pc          The code the time is charged to
+ *
+ *****************************************************************************/
+static void advance_time( uint64_t ns, uintptr_t pc ) {
+    while ( irq_enabled ) {
+        uint64_t next = next_interrupt();
+
+        if ( sim_now + ns < next ) {
+            break;
+        }
+
+        if ( next > sim_now ) {
+            ns -= next - sim_now;
+            sim_now = next;
+        }
+        serve_interrupts( pc );
+    }
+
+    sim_now += ns;
+}
+
+/******************************************************************************
+ * Helper function to find or create the host context of a task
+ *
+ * @param[in]   p_top       The stack top of the task in hkos_ram
+ *
+ * @return  The context or NULL if the host is out of memory
+ *
+ *****************************************************************************/
+static hkos_sim_context_t* get_context( void* p_top ) {
+    hkos_sim_context_t* p_context = p_contexts;
+
+    for (; p_context != NULL; p_context = p_context->p_next ) {
+        if ( p_context->p_top == p_top )
+            return p_context;
+    }
+
+    p_context = malloc( sizeof(hkos_sim_context_t) );
+    if ( p_context != NULL ) {
+        p_context->p_stack = malloc( HKOS_SIM_TASK_STACK );
+        if ( p_context->p_stack == NULL ) {
+            free( p_context );
+            return NULL;
+        }
+        p_context->p_top = p_top;
+        p_context->p_next = p_contexts;
+        p_contexts = p_context;
+    }
+
+    return p_context;
+}
+
+/******************************************************************************
+ * Task entry point
+ *
+ * Starts with interrupts disabled, like every task resumed by a context
+ * switch. A task function that returns is removed.
+ *
+ *****************************************************************************/
+static void task_entry( void ) {
+    hkos_sim_context_t* p_context = *(hkos_sim_context_t**)
+                                    hkos_ram.runtime_data.p_running_task->p_sp;
+
+    irq_enabled = true;
+    advance_time( 0, (uintptr_t)p_context->p_entry );
+    p_context->p_entry( p_context->p_arg );
+    hkos_scheduler_exit_task();
+}
+
+/******************************************************************************
+ * Called for the irq events of the script
+ *
+ * @param[in]   irq         The interrupt number
+ * @param[in]   arg         The argument of the event, 0 if there is none
+ *
+ *****************************************************************************/
+void __attribute__((weak)) hkos_sim_irq_hook( uint8_t irq, uint32_t arg ) {
+    // default implementation does nothing
+}
+
+/******************************************************************************
+ * Charge execution time to the running task
+ *
+ * @param[in]   ns          Execution time in nanoseconds
+ *
+ *****************************************************************************/
+void hkos_sim_consume( uint32_t ns ) {
+    advance_time( ns, (uintptr_t)__builtin_return_address(0) );
+}
+
+/******************************************************************************
+ * Get the virtual time
+ *
+ * @return  Nanoseconds since the simulation started
+ *
+ *****************************************************************************/
+uint64_t hkos_sim_time( void ) {
+    return sim_now;
+}
+
+#if HKOS_MULTI_INSTANCE
+/******************************************************************************
+ * Add an instance of HalfKOS
+ *
+ * @param[in]   p_setup     The setup function of the instance
+ *
+ * @return  The number of the instance or -1 if it cannot be added
+ *
+ *****************************************************************************/
+int hkos_sim_add_instance( void (*p_setup)( void ) ) {
+    if ( instance_id != 0 || next_sync != NEVER )
+        return -1;
+
+    void (**p_new)( void ) = realloc( p_setups,
+                                      ( instance_count + 1 ) * sizeof(*p_setups) );
+    if ( p_new == NULL )
+        return -1;
+
+    p_setups = p_new;
+    p_setups[instance_count] = p_setup;
+    return instance_count++;
+}
+
+/******************************************************************************
+ * Get the number of the instance running the caller
+ *
+ * @return  The instance number
+ *
+ *****************************************************************************/
+unsigned hkos_sim_instance( void ) {
+    return instance_id;
+}
+
+/******************************************************************************
+ * Get the number of instances
+ *
+ * @return  The number of instances, including instance 0
+ *
+ *****************************************************************************/
+unsigned hkos_sim_instance_count( void ) {
+    return instance_count;
+}
+#endif
+
+/******************************************************************************
+ *  Initialize the HAL and put the system at its initial state
+ *
+ * Opens the script. Interrupts stay disabled until HalfKOS starts.
+ *
+ *****************************************************************************/
+void hkos_hal_init( void ) {
+    next_tick = NEVER;
+    next_event.time = NEVER;
+
+    const char* p_path = getenv( "HKOS_SIM_SCRIPT" );
+
+#if HKOS_MULTI_INSTANCE
+    // the script drives instance 0 only
+    next_sync = NEVER;
+    if ( instance_id != 0 )
+        p_path = NULL;
+#endif
+    if ( p_path != NULL ) {
+        p_script = fopen( p_path, "r" );
+        if ( p_script == NULL ) {
+            fprintf( stderr, "HalfKOS: cannot open %s\n", p_path );
+            exit( 2 );
+        }
+    }
+    read_next_event();
+}
+
+/******************************************************************************
+ * Initialize the task stack.
+ *
+ * The task runs on a host stack, so its stack in hkos_ram only holds a
+ * pointer to the host context. The context starts the task in task_entry.
+ *
+ * @param[in]   p_sp        a pointer to the stack pointer indicating the
+ *                          memory region of the task stack
+ * @param[in]   p_pc        a pointer to the beginning of the task code
+ * @param[in]   p_arg       the argument of the task code
+ * @param[in]   stack_size  the size of the task's stack
+ *
+ * @return  The value of stack pointer after the stack initialization or
+ *          NULL if the host is out of memory
+ *
+ *****************************************************************************/
+void* hkos_hal_init_stack( void* p_sp, void* p_pc, void* p_arg,
+                           hkos_size_t stack_size )
+{
+    hkos_sim_context_t* p_context = get_context( p_sp );
+    if ( p_context == NULL )
+        return NULL;
+
+    p_context->p_entry = (void (*)( void* ))p_pc;
+    p_context->p_arg = p_arg;
+
+    getcontext( &p_context->context );
+    p_context->context.uc_stack.ss_sp = p_context->p_stack;
+    p_context->context.uc_stack.ss_size = HKOS_SIM_TASK_STACK;
+    p_context->context.uc_link = NULL;
+    makecontext( &p_context->context, task_entry, 0 );
+
+    hkos_sim_context_t** p_stack = (hkos_sim_context_t**)p_sp;
+    *--p_stack = p_context;
+
+    uint8_t* ret_stack = (uint8_t*)p_stack;
+
+    // The stack in hkos_ram is never used, but it is painted like on the
+    // MCUs, so the stack usage analysis works
+    if ( HKOS_PAINT_TASK_STACK ) {
+        uint8_t* p_paint = ret_stack;
+        stack_size += hkos_hal_get_min_stack_size();
+        while ( p_paint > (uint8_t*)p_sp - stack_size ) {
+            *--p_paint = HKOS_STACK_PAINT_VALUE;
+        }
+    }
+
+    return ret_stack;
+}
+
+/******************************************************************************
+ * Get the minimal stack size
+ *
+ * The stack in hkos_ram only holds the pointer to the host context.
+ *
+ *****************************************************************************/
+hkos_size_t hkos_hal_get_min_stack_size( void ) {
+    return sizeof(hkos_sim_context_t*);
+}
+
+/******************************************************************************
+ * Jump to the operating system
+ *
+ * Starts the tick timer and turns main into the idle loop. When idle, the
+ * virtual clock jumps to the next interrupt. Instance 0 also starts the
+ * other instances.
+ *
+ *****************************************************************************/
+void hkos_hal_jump_to_os( void ) {
+
+    // We paint the OS stack to help debug
+    if ( HKOS_PAINT_TASK_STACK ) {
+        for ( hkos_size_t i = 0; i < arraysize(hkos_ram.os_stack); ++i ) {
+            hkos_ram.os_stack[i] = HKOS_STACK_PAINT_VALUE;
+        }
+    }
+
+    last_tick = sim_now;
+    next_tick = sim_now + TICK_PERIOD_NS;
+    irq_enabled = true;
+
+#if HKOS_MULTI_INSTANCE
+    if ( instance_id == 0 )
+        start_instances();
+
+    sem_wait( &workers );
+    next_sync = HKOS_SIM_LINK_LATENCY;
+#endif
+
+    while ( 1 ) {
+#if !HKOS_PREEMPTION
+        // without preemption, the idle loop yields to the ready tasks
+        hkos_scheduler_yield();
+#endif
+        uint64_t next = next_interrupt();
+        if ( next > sim_now )
+            sim_now = next;
+
+        serve_interrupts( 0 );
+    }
+}
+
+/******************************************************************************
+ * Yield the CPU to the next task
+ *
+ * Returns when the caller runs again.
+ *
+ *****************************************************************************/
+void hkos_hal_yield( void ) {
+    bool enabled = irq_enabled;
+    irq_enabled = false;
+
+    hkos_task_t* p_previous = hkos_ram.runtime_data.p_running_task;
+    hkos_scheduler_switch_context();
+    switch_task( p_previous );
+
+    irq_enabled = enabled;
+    advance_time( 0, (uintptr_t)__builtin_return_address(0) );
+}
+
+/******************************************************************************
+ * Enter Critical Section
+ *
+ * OBS: this function must not be called by user code, because it may affect
+ * the time counting. All use of this function MUST be restricted to HalfKOS
+ * core.
+ *
+ *****************************************************************************/
+void hkos_hal_enter_critical_section( void ) {
+#if HKOS_IRQ_STATS
+    if ( irq_enabled )
+        irq_disabled_begin( (uintptr_t)__builtin_return_address(0) );
+#endif
+    irq_enabled = false;
+}
+
+/******************************************************************************
+ * Exit Critical Section
+ *
+ * Charges the cost of the kernel call, so the interrupts that became due
+ * in the critical section are served here.
+ *
+ * OBS: this function must not be called by user code, because it may affect
+ * the time counting. All use of this function MUST be restricted to HalfKOS
+ * core.
+ *
+ *****************************************************************************/
+void hkos_hal_exit_critical_section( void ) {
+#if HKOS_IRQ_STATS
+    irq_disabled_end();
+#endif
+    irq_enabled = true;
+    advance_time( HKOS_SIM_KERNEL_COST, (uintptr_t)__builtin_return_address(0) );
+}
+
+/******************************************************************************
+ * Save the interrupt state and disable interrupts
+ *
+ * @return  True if the interrupts were enabled
+ *
+ *****************************************************************************/
+hkos_irq_state_t hkos_hal_irq_save( void ) {
+    hkos_irq_state_t state = irq_enabled;
+
+#if HKOS_IRQ_STATS
+    if ( state )
+        irq_disabled_begin( (uintptr_t)__builtin_return_address(0) );
+#endif
+    irq_enabled = false;
+    return state;
+}
+
+/******************************************************************************
+ * Restore the interrupt state saved by hkos_hal_irq_save
+ *
+ * @param[in]   state       The state returned by hkos_hal_irq_save
+ *
+ *****************************************************************************/
+void hkos_hal_irq_restore( hkos_irq_state_t state ) {
+    if ( state ) {
+#if HKOS_IRQ_STATS
+        irq_disabled_end();
+#endif
+        irq_enabled = true;
+        advance_time( 0, (uintptr_t)__builtin_return_address(0) );
+    }
+}
+
+/******************************************************************************
+ * Get the time elapsed since the last tick
+ *
+ * @return  Virtual time since the last tick in microseconds
+ *
+ *****************************************************************************/
+uint16_t hkos_hal_get_tick_fraction( void ) {
+    uint64_t fraction = ( sim_now - last_tick ) / 1000;
+
+    if ( fraction >= 2 * HKOS_HAL_TICK_FRACTIONS )
+        fraction = 2 * HKOS_HAL_TICK_FRACTIONS - 1;
+
+    return (uint16_t)fraction;
+}
+
+/******************************************************************************
+ * Get the cycle counter
+ *
+ * @return  The virtual time in nanoseconds
+ *
+ *****************************************************************************/
+uint32_t hkos_hal_get_cycles( void ) {
+    return (uint32_t)sim_now;
+}
+
+#if HKOS_IRQ_STATS
+/******************************************************************************
+ * Get the interrupt statistics
+ *
+ * Times are in nanoseconds of virtual time. The latency is how long the
+ * interrupts wait for the interrupts to be enabled.
+ *
+ * @param[out]  p_stats     The statistics
+ *
+ *****************************************************************************/
+void hkos_hal_get_irq_stats( hkos_irq_stats_t* p_stats ) {
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    *p_stats = irq_stats;
+    hkos_hal_irq_restore( state );
+}
+
+/******************************************************************************
+ * Discard the interrupt statistics
+ *
+ *****************************************************************************/
+void hkos_hal_reset_irq_stats( void ) {
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    irq_stats = (hkos_irq_stats_t){ 0, 0, 0, 0 };
+    hkos_hal_irq_restore( state );
+}
+#endif
+
+/******************************************************************************
+ * Get the program counter saved in the context of a task
+ *
+ * Tasks are only interrupted when they charge time, so this is the code
+ * that charged the time of the tick.
+ *
+ * @param[in]   p_sp        The stack pointer saved in the task structure
+ *
+ * @return  The address the task was executing when it was interrupted
+ *
+ *****************************************************************************/
+uintptr_t hkos_hal_get_saved_pc( void* p_sp ) {
+    return interrupted_pc;
+}
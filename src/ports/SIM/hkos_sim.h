@@ -0,0 +1,161 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *
+ * Virtual time simulation interface
+ *
+ * In the SIM port, time only advances when tasks consume modelled execution
+ * time, when the kernel charges its own costs and when the CPU is idle, in
+ * which case it jumps to the next event. Ticks and the events of the script
+ * named by the environment variable HKOS_SIM_SCRIPT are injected as
+ * interrupts at those points only, so a run is fully reproducible.
+ *
+ * Each line of the script is "<time in us> <event> [arguments]", in
+ * non-decreasing time order. Empty lines and lines starting with # are
+ * ignored. The events are:
+ *
+ *      serial <port> <text>    the port receives the text; \n, \r and \\
+ *                              are escapes
+ *      gpio <pin> <0|1>        the input pin changes
+ *      irq <number> [arg]      hkos_sim_irq_hook is called as an ISR
+ *      end [code]              the simulation ends with the exit code
+ *
+ * Without an end event, the simulation never ends.
+ *
+ * A task that loops without calling HalfKOS or hkos_sim_consume stops the
+ * virtual clock, so it is never preempted.
+ *
+ * If HKOS_MULTI_INSTANCE is set in hkos_config.h, the process runs many
+ * instances of HalfKOS, each with its own kernel, virtual clock and
+ * peripherals:
+ *
+ *      - instance 0 runs setup and may add the other instances, each with
+ *        its own setup function
+ *      - each instance runs on its own host thread, and the environment
+ *        variable HKOS_SIM_WORKERS limits how many run at the same time,
+ *        by default the number of processors
+ *      - the instances synchronize every HKOS_SIM_LINK_LATENCY of virtual
+ *        time, so a run does not depend on the host scheduler
+ *      - serial ports of different instances talk through lines. What a
+ *        port transmits is received by the other ports on the same line
+ *        HKOS_SIM_LINK_LATENCY later, so a line with two ports is a point
+ *        to point link and a line with more ports is a bus
+ *      - the script drives instance 0 and its end event ends the whole
+ *        simulation. Only instance 0 uses stdout and the environment
+ *        variables of the serial ports. The other ports not connected to
+ *        a line discard their data.
+ *
+ * An instance whose virtual clock stops stops all the others.
+ *
+ *****************************************************************************/
+#ifndef __HKOS_SIM_H
+#define __HKOS_SIM_H
+
+#include <inttypes.h>
+#include <hkos_core.h>
+#include <hkos_errors.h>
+
+/******************************************************************************
+ * Charge execution time to the running task
+ *
+ * Models the task computing for the given time. The interrupts due in the
+ * meantime are served, so the task may be preempted.
+ *
+ * @param[in]   ns          Execution time in nanoseconds
+ *
+ *****************************************************************************/
+void hkos_sim_consume( uint32_t ns );
+
+
+/******************************************************************************
+ * Get the virtual time
+ *
+ * @return  Nanoseconds since the simulation started
+ *
+ *****************************************************************************/
+uint64_t hkos_sim_time( void );
+
+
+/******************************************************************************
+ * Called for the irq events of the script
+ *
+ * Runs as an interrupt service routine, so it may only call the HalfKOS
+ * functions allowed in ISRs. The default does nothing.
+ *
+ * @param[in]   irq         The interrupt number
+ * @param[in]   arg         The argument of the event, 0 if there is none
+ *
+ *****************************************************************************/
+void hkos_sim_irq_hook( uint8_t irq, uint32_t arg );
+
+#if HKOS_MULTI_INSTANCE
+/******************************************************************************
+ * Add an instance of HalfKOS
+ *
+ * May only be called by the setup function of instance 0. The new instance
+ * is initialized and runs p_setup on its own thread when HalfKOS starts.
+ *
+ * @param[in]   p_setup     The setup function of the instance
+ *
+ * @return  The number of the instance or -1 if it cannot be added
+ *
+ *****************************************************************************/
+int hkos_sim_add_instance( void (*p_setup)( void ) );
+
+
+/******************************************************************************
+ * Get the number of the instance running the caller
+ *
+ * @return  The instance number, 0 for the instance that runs setup
+ *
+ *****************************************************************************/
+unsigned hkos_sim_instance( void );
+
+
+/******************************************************************************
+ * Get the number of instances
+ *
+ * @return  The number of instances, including instance 0
+ *
+ *****************************************************************************/
+unsigned hkos_sim_instance_count( void );
+
+
+/******************************************************************************
+ * Connect a serial port of an instance to a line
+ *
+ * May only be called by the setup function of instance 0, after adding the
+ * instance. Lines are created when the first port connects to them.
+ *
+ * @param[in]   instance    The instance number
+ * @param[in]   port        The serial port of the instance
+ * @param[in]   line        The line number
+ *
+ * @return  HKOS_ERROR_NONE or error code
+ *
+ *****************************************************************************/
+hkos_error_code_t hkos_sim_connect( unsigned instance, uint8_t port,
+                                    unsigned line );
+#endif
+
+#endif // __HKOS_SIM_H
@@ -0,0 +1,215 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/**************************************************************************
+ *
+ * HalfKOS GPIO implementation for the virtual time simulator
+ *
+ * The pins are kept in memory and the script drives the inputs. Changes of
+ * the outputs are logged to stderr, or to the file named by the environment
+ * variable HKOS_GPIO_LOG, one line per change: "<us> <pin> <value>", with
+ * the virtual time in microseconds. With HKOS_MULTI_INSTANCE, the instances
+ * share the log and the pin is "<instance>:<pin>".
+ *
+ * ************************************************************************/
+#include <core/hkos_hal.h>
+#include <core/peripherals/gpio/hkos_gpio_hal.h>
+#include <hkos_sim.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#if HKOS_MULTI_INSTANCE
+#include <pthread.h>
+#endif
+
+// General Macros
+//
+#define arraysize(x)    (sizeof(x) / sizeof(x[0]))
+
+// Pins are numbered from 0 to HKOS_SIM_GPIO_PINS - 1
+#ifndef HKOS_SIM_GPIO_PINS
+#define HKOS_SIM_GPIO_PINS    32
+#endif
+
+/******************************************************************************
+ * State of a GPIO pin
+ *
+ *****************************************************************************/
+typedef struct {
+    hkos_gpio_pin_mode_t    mode;
+    hkos_gpio_value_t       value;
+} hkos_sim_gpio_t;
+
+static HKOS_INSTANCE_LOCAL hkos_sim_gpio_t gpio_pins[HKOS_SIM_GPIO_PINS];
+static int log_fd = -1;
+
+#if HKOS_MULTI_INSTANCE
+static pthread_once_t log_once = PTHREAD_ONCE_INIT;
+#endif
+
+/******************************************************************************
+ * Helper function to open the log
+ *
+ *****************************************************************************/
+static void open_log( void ) {
+    const char* p_path = getenv( "HKOS_GPIO_LOG" );
+    log_fd = ( p_path == NULL ) ? STDERR_FILENO
+                : open( p_path, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+}
+
+/******************************************************************************
+ * Helper function to log the change of a pin
+ *
+ * @param[in]   pin     pin number
+ *
+ *****************************************************************************/
+static void log_pin( uint8_t pin ) {
+
+#if HKOS_MULTI_INSTANCE
+    pthread_once( &log_once, open_log );
+#else
+    if ( log_fd < 0 )
+        open_log();
+#endif
+
+    char line[48];
+#if HKOS_MULTI_INSTANCE
+    int size = snprintf( line, sizeof(line), "%llu %u:%u %s\n",
+                         (unsigned long long)( hkos_sim_time() / 1000 ),
+                         hkos_sim_instance(), pin,
+                         gpio_pins[pin].value == HIGH ? "HIGH" : "LOW" );
+#else
+    int size = snprintf( line, sizeof(line), "%llu %u %s\n",
+                         (unsigned long long)( hkos_sim_time() / 1000 ),
+                         pin, gpio_pins[pin].value == HIGH ? "HIGH" : "LOW" );
+#endif
+
+    if ( log_fd >= 0 && size > 0 )
+        (void)!write( log_fd, line, size );
+}
+
+/******************************************************************************
+ * Helper function to change the value of a pin
+ *
+ * The value is stored even if the pin is an input, so it is the output
+ * value when the pin becomes an output.
+ *
+ * @param[in]   pin     pin number
+ * @param[in]   value   the new value
+ *
+ *****************************************************************************/
+static void set_pin( uint8_t pin, hkos_gpio_value_t value ) {
+    hkos_irq_state_t state = hkos_hal_irq_save();
+
+    bool changed = gpio_pins[pin].value != value;
+    gpio_pins[pin].value = value;
+
+    if ( changed && gpio_pins[pin].mode == OUTPUT )
+        log_pin( pin );
+
+    hkos_hal_irq_restore( state );
+}
+
+/******************************************************************************
+ * Configure a GPIO pin
+ *
+ * An input pin reads its pull, or LOW if it has none.
+ *
+ * @param[in]   pin     pin number
+ * @param[in]   mode    the mode selected from the pin mode enumeration
+ *
+ *****************************************************************************/
+void hkos_gpio_config( uint8_t pin, hkos_gpio_pin_mode_t mode )
+{
+    if ( pin >= arraysize(gpio_pins) )
+        return;
+
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    gpio_pins[pin].mode = mode;
+
+    if ( mode == OUTPUT ) {
+        log_pin( pin );
+    } else {
+        gpio_pins[pin].value = ( mode == INPUT_PULLUP ) ? HIGH : LOW;
+    }
+    hkos_hal_irq_restore( state );
+}
+
+/******************************************************************************
+ * Write a value to a GPIO pin
+ *
+ * @param[in]   pin     pin number
+ * @param[in]   value   the value selected from the pin value enumeration
+ *
+ *****************************************************************************/
+void hkos_gpio_write( uint8_t pin, hkos_gpio_value_t value )
+{
+    if ( pin < arraysize(gpio_pins) )
+        set_pin( pin, value );
+}
+
+/******************************************************************************
+ * Toggle the value of a GPIO pin
+ *
+ * @param[in]   pin     pin number
+ *
+ *****************************************************************************/
+void hkos_gpio_toggle( uint8_t pin )
+{
+    if ( pin < arraysize(gpio_pins) )
+        set_pin( pin, gpio_pins[pin].value == HIGH ? LOW : HIGH );
+}
+
+/******************************************************************************
+ * Read the value of a GPIO pin
+ *
+ * @param[in]   pin     pin number
+ *
+ * @return  The value of the GPIO pin taken from the pin value enumeration
+ *
+ *****************************************************************************/
+hkos_gpio_value_t hkos_gpio_read( uint8_t pin )
+{
+    if ( pin >= arraysize(gpio_pins) )
+        return LOW;
+
+    return gpio_pins[pin].value;
+}
+
+/******************************************************************************
+ * Change the value of an input pin
+ *
+ * Called for the gpio events of the script. Output pins are not changed.
+ *
+ * @param[in]   pin     pin number
+ * @param[in]   value   the value selected from the pin value enumeration
+ *
+ *****************************************************************************/
+void hkos_sim_gpio_input( uint8_t pin, hkos_gpio_value_t value )
+{
+    if ( pin < arraysize(gpio_pins) && gpio_pins[pin].mode != OUTPUT )
+        gpio_pins[pin].value = value;
+}
@@ -0,0 +1,512 @@
+/******************************************************************************
+ *
+ * This file is part of HalfKOS.
+ * https://github.com/alairjunior/HalfKOS
+ *
+ * Copyright (c) 2025 Alair Dias Junior.
+ *
+ * HalfKOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HalfKOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+/**************************************************************************
+ *
+ * HalfKOS serial port implementation for the virtual time simulator
+ *
+ * The script is the only source of received data. Port 0 transmits to
+ * stdout and port n to the file named by the environment variable
+ * HKOS_SERIAL<n>, if set. Otherwise, the data is discarded.
+ *
+ * Transmission takes no virtual time and the line settings are ignored.
+ *
+ * With HKOS_MULTI_INSTANCE, the ports connected to a line transmit to the
+ * other ports on the line instead. The data sent in each quantum is kept
+ * by the sender, with the time it is received, until the receivers collect
+ * it in the next synchronization.
+ *
+ * ************************************************************************/
+#include <hkos_errors.h>
+#include <core/hkos_hal.h>
+#include <core/hkos_scheduler.h>
+#include <core/peripherals/serial/hkos_serial_hal.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if HKOS_MULTI_INSTANCE
+#include <hkos_sim.h>
+#endif
+
+// Serial port interface is only enabled when there are serial ports enabled
+#if HKOS_SERIAL_PORTS_ENABLE > 0
+
+#if HKOS_SERIAL_PORTS_ENABLE > 10
+#error SIM port supports up to 10 serial ports.
+#endif
+
+extern HKOS_INSTANCE_LOCAL hkos_serial_ring_buffer hkos_serial_rx_buffer[HKOS_SERIAL_PORTS_ENABLE];
+extern HKOS_INSTANCE_LOCAL hkos_serial_ring_buffer hkos_serial_tx_buffer[HKOS_SERIAL_PORTS_ENABLE];
+
+/******************************************************************************
+ * State of the serial ports
+ *
+ *****************************************************************************/
+typedef struct {
+    bool    open;
+    int     fd_out;         // -1 if the data is discarded
+} hkos_sim_serial_t;
+
+static HKOS_INSTANCE_LOCAL hkos_sim_serial_t serial_ports[HKOS_SERIAL_PORTS_ENABLE];
+
+#if HKOS_MULTI_INSTANCE
+/******************************************************************************
+ * Data sent through a line
+ *
+ *****************************************************************************/
+typedef struct {
+    uint64_t    time;           // ns, when it is received
+    uint8_t     port;           // receiving port, when received
+    uint8_t     size;
+    char        data[HKOS_SERIAL_BUFFER_SIZE];
+} hkos_sim_chunk_t;
+
+typedef struct {
+    hkos_sim_chunk_t*   p_chunks;
+    unsigned            count;
+    unsigned            capacity;
+} hkos_sim_chunks_t;
+
+/******************************************************************************
+ * A port connected to a line
+ *
+ * The data sent in a quantum is collected by the receivers in the next one,
+ * while the sender uses the other list.
+ *
+ *****************************************************************************/
+typedef struct {
+    unsigned            instance;
+    uint8_t             port;
+    unsigned            line;
+    hkos_sim_chunks_t   sent[2];        // by quantum parity
+} hkos_sim_line_port_t;
+
+typedef struct {
+    hkos_sim_line_port_t**  p_ports;
+    unsigned                count;
+} hkos_sim_line_t;
+
+// Lines and the connected ports of each instance, created by instance 0
+// before HalfKOS starts
+static hkos_sim_line_t* p_lines;
+static unsigned line_count;
+static hkos_sim_line_port_t* (*p_connections)[HKOS_SERIAL_PORTS_ENABLE];
+static unsigned connected_instances;
+
+static HKOS_INSTANCE_LOCAL uint32_t quantum;
+static HKOS_INSTANCE_LOCAL hkos_sim_chunks_t received;  // sorted by time
+static HKOS_INSTANCE_LOCAL unsigned next_received;
+
+/******************************************************************************
+ * Helper function to get the line connection of a port of this instance
+ *
+ * @param[in]   port        Port number
+ *
+ * @return  The connection or NULL if the port is not connected to a line
+ *
+ *****************************************************************************/
+static hkos_sim_line_port_t* connection_of( uint8_t port ) {
+    unsigned instance = hkos_sim_instance();
+
+    if ( instance >= connected_instances )
+        return NULL;
+
+    return p_connections[instance][port];
+}
+
+/******************************************************************************
+ * Helper function to append a chunk to a list
+ *
+ * @param[inout]    p_list      The list
+ *
+ * @return  The new chunk or NULL if the host is out of memory
+ *
+ *****************************************************************************/
+static hkos_sim_chunk_t* append_chunk( hkos_sim_chunks_t* p_list ) {
+    if ( p_list->count == p_list->capacity ) {
+        unsigned capacity = p_list->capacity ? 2 * p_list->capacity : 16;
+        hkos_sim_chunk_t* p_new = realloc( p_list->p_chunks,
+                                           capacity * sizeof(hkos_sim_chunk_t) );
+        if ( p_new == NULL )
+            return NULL;
+
+        p_list->p_chunks = p_new;
+        p_list->capacity = capacity;
+    }
+
+    return &p_list->p_chunks[ p_list->count++ ];
+}
+
+/******************************************************************************
+ * Helper function to send data through a line
+ *
+ * @param[in]   p_connection    The line connection of the port
+ * @param[in]   p_data          The data
+ * @param[in]   size            Its size, up to HKOS_SERIAL_BUFFER_SIZE
+ *
+ *****************************************************************************/
+static void send_chunk( hkos_sim_line_port_t* p_connection,
+                        const char* p_data, uint8_t size ) {
+    hkos_sim_chunks_t* p_sent = &p_connection->sent[ quantum % 2 ];
+    uint64_t time = hkos_sim_time() + HKOS_SIM_LINK_LATENCY;
+
+    // the data sent at the same time is received at once, so writing byte
+    // by byte does not cost an interrupt per byte
+    if ( p_sent->count > 0 ) {
+        hkos_sim_chunk_t* p_last = &p_sent->p_chunks[ p_sent->count - 1 ];
+
+        if ( p_last->time == time &&
+             p_last->size + size <= HKOS_SERIAL_BUFFER_SIZE ) {
+            memcpy( &p_last->data[ p_last->size ], p_data, size );
+            p_last->size += size;
+            return;
+        }
+    }
+
+    hkos_sim_chunk_t* p_chunk = append_chunk( p_sent );
+
+    // like a disconnected line, if the host is out of memory
+    if ( p_chunk == NULL )
+        return;
+
+    p_chunk->time = time;
+    p_chunk->size = size;
+    memcpy( p_chunk->data, p_data, size );
+}
+
+/**************************************************************************
+ * Connect a serial port of an instance to a line
+ *
+ * @param[in]       instance        The instance number
+ * @param[in]       port            Port number
+ * @param[in]       line            The line number
+ *
+ * @return      HKOS_ERROR_NONE or error code
+ *
+ * ************************************************************************/
+hkos_error_code_t hkos_sim_connect( unsigned instance, uint8_t port,
+                                    unsigned line )
+{
+    if ( hkos_sim_instance() != 0 || instance >= hkos_sim_instance_count()
+            || port >= HKOS_SERIAL_PORTS_ENABLE )
+        return HKOS_ERROR_INVALID_RESOURCE;
+
+    if ( instance < connected_instances && p_connections[instance][port] != NULL )
+        return HKOS_ERROR_RESOURCE_BUSY;
+
+    if ( instance >= connected_instances ) {
+        void* p_new = realloc( p_connections,
+                               ( instance + 1 ) * sizeof(*p_connections) );
+        if ( p_new == NULL )
+            return HKOS_ERROR_INVALID_RESOURCE;
+
+        p_connections = p_new;
+        memset( &p_connections[connected_instances], 0,
+                ( instance + 1 - connected_instances ) * sizeof(*p_connections) );
+        connected_instances = instance + 1;
+    }
+
+    if ( line >= line_count ) {
+        hkos_sim_line_t* p_new = realloc( p_lines,
+                                          ( line + 1 ) * sizeof(hkos_sim_line_t) );
+        if ( p_new == NULL )
+            return HKOS_ERROR_INVALID_RESOURCE;
+
+        p_lines = p_new;
+        memset( &p_lines[line_count], 0,
+                ( line + 1 - line_count ) * sizeof(hkos_sim_line_t) );
+        line_count = line + 1;
+    }
+
+    hkos_sim_line_t* p_line = &p_lines[line];
+    hkos_sim_line_port_t** p_ports = realloc( p_line->p_ports,
+                                ( p_line->count + 1 ) * sizeof(*p_ports) );
+    hkos_sim_line_port_t* p_port = calloc( 1, sizeof(hkos_sim_line_port_t) );
+
+    if ( p_ports == NULL || p_port == NULL ) {
+        free( p_port );
+        return HKOS_ERROR_INVALID_RESOURCE;
+    }
+
+    p_port->instance = instance;
+    p_port->port = port;
+    p_port->line = line;
+    p_ports[ p_line->count++ ] = p_port;
+    p_line->p_ports = p_ports;
+    p_connections[instance][port] = p_port;
+
+    return HKOS_ERROR_NONE;
+}
+
+#endif
+
+/**************************************************************************
+ * Open a serial port
+ *
+ * @param[in]       port            Port number
+ * @param[in]       baud            Baud rate
+ * @param[in]       data_bits       Number of data bits
+ * @param[in]       stop_bits       Number of stop bits
+ * @param[in]       parity          Parity
+ *
+ * @return      HKOS_ERROR_NONE or error code
+ *
+ * ************************************************************************/
+hkos_error_code_t hkos_arch_serial_open(    uint8_t port,
+                                            uint32_t baud,
+                                            hkos_serial_data_bits_t data_bits,
+                                            hkos_serial_stop_bits_t stop_bits,
+                                            hkos_serial_parity_t parity )
+{
+    if ( port >= HKOS_SERIAL_PORTS_ENABLE )
+        return HKOS_ERROR_INVALID_RESOURCE;
+
+    if ( serial_ports[port].open )
+        return HKOS_ERROR_RESOURCE_BUSY;
+
+#if HKOS_MULTI_INSTANCE
+    // the outputs of the host belong to instance 0, so the ports of the
+    // other instances that are not connected to a line discard their data
+    if ( connection_of( port ) != NULL || hkos_sim_instance() != 0 ) {
+        serial_ports[port].fd_out = -1;
+        serial_ports[port].open = true;
+        return HKOS_ERROR_NONE;
+    }
+#endif
+
+    char name[] = "HKOS_SERIAL0";
+    name[ sizeof(name) - 2 ] += port;
+    const char* p_path = getenv( name );
+
+    int fd_out = -1;
+    if ( p_path != NULL ) {
+        fd_out = open( p_path, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+        if ( fd_out < 0 )
+            return HKOS_ERROR_INVALID_RESOURCE;
+    } else if ( port == 0 ) {
+        fd_out = STDOUT_FILENO;
+    }
+
+    serial_ports[port].fd_out = fd_out;
+    serial_ports[port].open = true;
+
+    return HKOS_ERROR_NONE;
+}
+
+
+/**************************************************************************
+ * Closes a serial port
+ *
+ * @param[in]       port            Port number
+ *
+ * @return      HKOS_ERROR_NONE or error code
+ *
+ * ************************************************************************/
+hkos_error_code_t hkos_arch_serial_close( uint8_t port )
+{
+    // the tx buffer is always empty, because writes are done right away
+    hkos_irq_state_t state = hkos_hal_irq_save();
+    int fd = serial_ports[port].fd_out;
+    serial_ports[port].fd_out = -1;
+    serial_ports[port].open = false;
+
+    // discard all data in the rx buffer
+    hkos_serial_rx_buffer[port].head = hkos_serial_rx_buffer[port].tail;
+    hkos_hal_irq_restore( state );
+
+    if ( fd > STDERR_FILENO )
+        close( fd );
+
+    return HKOS_ERROR_NONE;
+}
+
+
+/**************************************************************************
+ * Signals that there is pending data in the tx buffer
+ *
+ * Writes the whole tx buffer to the port.
+ *
+ * @param[in]       port            Port number
+ *
+ * @return      HKOS_ERROR_NONE or error code
+ *
+ * ************************************************************************/
+hkos_error_code_t hkos_arch_serial_tx_pending( uint8_t port )
+{
+    hkos_serial_ring_buffer* p_tx = &hkos_serial_tx_buffer[port];
+    hkos_irq_state_t state = hkos_hal_irq_save();
+
+#if HKOS_MULTI_INSTANCE
+    hkos_sim_line_port_t* p_connection = connection_of( port );
+#endif
+
+    while ( p_tx->head != p_tx->tail ) {
+        uint8_t end = ( p_tx->head > p_tx->tail ) ? p_tx->head
+                                                  : HKOS_SERIAL_BUFFER_SIZE;
+
+        if ( serial_ports[port].fd_out >= 0 )
+            (void)!write( serial_ports[port].fd_out,
+                          &p_tx->buffer[p_tx->tail], end - p_tx->tail );
+#if HKOS_MULTI_INSTANCE
+        else if ( p_connection != NULL )
+            send_chunk( p_connection, &p_tx->buffer[p_tx->tail],
+                        end - p_tx->tail );
+#endif
+
+        p_tx->tail = end % HKOS_SERIAL_BUFFER_SIZE;
+    }
+
+    hkos_hal_irq_restore( state );
+    return HKOS_ERROR_NONE;
+}
+
+
+/**************************************************************************
+ * Receive data
+ *
+ * Called for the serial events of the script and for the data of the
+ * lines, as an interrupt. Characters that do not fit in the rx buffer are
+ * lost, like on the MCUs.
+ *
+ * @param[in]       port            Port number
+ * @param[in]       p_data          The characters received
+ * @param[in]       size            The number of characters
+ *
+ * ************************************************************************/
+void hkos_sim_serial_receive( uint8_t port, const char* p_data, size_t size )
+{
+    hkos_serial_ring_buffer* p_rx = &hkos_serial_rx_buffer[port];
+
+    if ( !serial_ports[port].open )
+        return;
+
+    for (; size > 0; --size, ++p_data ) {
+        uint8_t i = ( p_rx->head + 1 ) % HKOS_SERIAL_BUFFER_SIZE;
+
+        // Check if there is space before adding the character
+        if ( i != p_rx->tail ) {
+            p_rx->buffer[p_rx->head] = *p_data;
+            p_rx->head = i;
+        }
+        hkos_serial_signal_waiting_tasks( port );
+    }
+}
+
+#if HKOS_MULTI_INSTANCE
+/**************************************************************************
+ * Collect the data sent to this instance in the last quantum
+ *
+ * Called by the synchronization of the instances. The chunks are received
+ * in time order and, at the same time, in the order of the connections.
+ *
+ * @param[in]       new_quantum     The quantum starting now
+ *
+ * ************************************************************************/
+void hkos_sim_serial_sync( uint32_t new_quantum )
+{
+    unsigned instance = hkos_sim_instance();
+    unsigned pending = received.count - next_received;
+
+    quantum = new_quantum;
+
+    // drop the chunks already delivered
+    if ( next_received > 0 ) {
+        memmove( received.p_chunks, &received.p_chunks[next_received],
+                 pending * sizeof(hkos_sim_chunk_t) );
+        received.count = pending;
+        next_received = 0;
+    }
+
+    if ( instance >= connected_instances )
+        return;
+
+    for ( uint8_t port = 0; port < HKOS_SERIAL_PORTS_ENABLE; ++port ) {
+        hkos_sim_line_port_t* p_own = p_connections[instance][port];
+        if ( p_own == NULL )
+            continue;
+
+        // the receivers collected this list in the previous synchronization
+        p_own->sent[ quantum % 2 ].count = 0;
+
+        hkos_sim_line_t* p_line = &p_lines[ p_own->line ];
+        for ( unsigned i = 0; i < p_line->count; ++i ) {
+            hkos_sim_line_port_t* p_peer = p_line->p_ports[i];
+            if ( p_peer == p_own )
+                continue;
+
+            hkos_sim_chunks_t* p_sent = &p_peer->sent[ ( quantum - 1 ) % 2 ];
+            for ( unsigned j = 0; j < p_sent->count; ++j ) {
+                hkos_sim_chunk_t* p_chunk = append_chunk( &received );
+                if ( p_chunk == NULL )
+                    break;
+
+                *p_chunk = p_sent->p_chunks[j];
+                p_chunk->port = port;
+            }
+        }
+    }
+
+    // insertion sort keeps the order of the chunks received at the same time
+    for ( unsigned i = pending; i < received.count; ++i ) {
+        hkos_sim_chunk_t chunk = received.p_chunks[i];
+        unsigned j = i;
+
+        for (; j > 0 && received.p_chunks[j - 1].time > chunk.time; --j ) {
+            received.p_chunks[j] = received.p_chunks[j - 1];
+        }
+        received.p_chunks[j] = chunk;
+    }
+}
+
+/**************************************************************************
+ * Get when the next data of the lines is received
+ *
+ * @return      The virtual time in ns or UINT64_MAX if there is none
+ *
+ * ************************************************************************/
+uint64_t hkos_sim_serial_next_rx( void )
+{
+    if ( next_received == received.count )
+        return UINT64_MAX;
+
+    return received.p_chunks[next_received].time;
+}
+
+/**************************************************************************
+ * Receive the next data of the lines
+ *
+ * Called as an interrupt, when the data is due.
+ *
+ * ************************************************************************/
+void hkos_sim_serial_deliver( void )
+{
+    hkos_sim_chunk_t* p_chunk = &received.p_chunks[ next_received++ ];
+
+    hkos_sim_serial_receive( p_chunk->port, p_chunk->data, p_chunk->size );
+}
+#endif
+
+#endif// HKOS_SERIAL_PORTS_ENABLE > 0
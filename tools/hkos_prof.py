@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+###############################################################################
+#
+# This file is part of HalfKOS.
+# https://github.com/alairjunior/HalfKOS
+#
+# Copyright (c) 2025 Alair Dias Junior.
+#
+# HalfKOS is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# HalfKOS is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+#
+###############################################################################
+"""
+Map the samples of the HalfKOS PC-sampling profiler (HKOS_PROFILER) back to
+functions and print where each task spends its CPU time.
+
+The samples are the lines printed by hkos_profiler_dump, either saved to a
+file or read from the serial port (requires pyserial). The code regions
+printed by hkos_prof_dump, if any, are shown as well. The symbols come from
+the disassembly written by the disassemble target of the build, or from the
+ELF file itself through nm:
+
+    hkos_prof.py samples.txt build/apps/halfkos.dump
+    hkos_prof.py /dev/ttyACM0 build/apps/halfkos.elf --nm msp430-elf-nm
+"""
+
+import argparse
+import bisect
+import re
+import subprocess
+import sys
+from collections import defaultdict
+
+# "0000c000 <main>:" in the objdump output
+DUMP_SYMBOL = re.compile(r"^([0-9a-fA-F]+) <([^>]+)>:")
+
+
+def symbols_from_dump(path):
+    symbols = []
+    with open(path) as dump:
+        for line in dump:
+            match = DUMP_SYMBOL.match(line)
+            if match:
+                symbols.append((int(match.group(1), 16), match.group(2)))
+    return symbols
+
+
+def symbols_from_elf(path, nm):
+    output = subprocess.run([nm, "-n", path], check=True,
+                            capture_output=True, text=True).stdout
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 3 and fields[1] in "tTwW":
+            symbols.append((int(fields[0], 16), fields[2]))
+    return symbols
+
+
+class SymbolTable:
+
+    def __init__(self, symbols):
+        symbols.sort()
+        self.addresses = [address for address, _ in symbols]
+        self.names = [name for _, name in symbols]
+
+    def lookup(self, pc):
+        i = bisect.bisect_right(self.addresses, pc) - 1
+        if i < 0:
+            return "0x%04x" % pc
+        return self.names[i]
+
+
+def read_lines(source, baud, seconds):
+    if source.startswith("/dev/") or source.upper().startswith("COM"):
+        import time
+        import serial
+
+        data = bytearray()
+        with serial.Serial(source, baud, timeout=0.1) as link:
+            end = time.monotonic() + seconds
+            while time.monotonic() < end:
+                data += link.read(4096)
+        return data.decode("ascii", "replace").splitlines()
+
+    with open(source) as samples:
+        return samples.read().splitlines()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("samples", help="hkos_profiler_dump output or serial port")
+    parser.add_argument("symbols", help="disassembly (.dump) or ELF file")
+    parser.add_argument("--nm", default="msp430-elf-nm",
+                        help="nm used to read the symbols of an ELF file")
+    parser.add_argument("--baud", type=int, default=9600,
+                        help="baud rate when reading from a serial port")
+    parser.add_argument("--seconds", type=float, default=5,
+                        help="capture time when reading from a serial port")
+    args = parser.parse_args()
+
+    if args.symbols.endswith(".dump"):
+        table = SymbolTable(symbols_from_dump(args.symbols))
+    else:
+        table = SymbolTable(symbols_from_elf(args.symbols, args.nm))
+
+    per_task = defaultdict(lambda: defaultdict(int))
+    samples = idle = missed = None
+    regions = []
+
+    for line in read_lines(args.samples, args.baud, args.seconds):
+        fields = line.split()
+        if len(fields) == 4 and fields[0] == "P":
+            task, pc, count = (int(field, 16) for field in fields[1:])
+            per_task[task][table.lookup(pc)] += count
+        elif len(fields) == 4 and fields[0] == "T":
+            samples, idle, missed = (int(field, 16) for field in fields[1:])
+        elif len(fields) == 6 and fields[0] == "R":
+            regions.append([int(field, 16) for field in fields[1:]])
+
+    if regions:
+        print("region     count        min        max       mean  (cycles)")
+        for region in regions:
+            print("%6d %9d %10d %10d %10d" % tuple(region))
+        if samples is None:
+            return
+        print()
+
+    if samples is None:
+        sys.exit("no profiler statistics found in the samples")
+
+    if samples == 0:
+        sys.exit("no samples")
+
+    print("%d samples, %.1f%% idle, %d missed (table full)"
+          % (samples, 100.0 * idle / samples, missed))
+
+    for task in sorted(per_task):
+        functions = per_task[task]
+        total = sum(functions.values())
+        print("\ntask 0x%04x: %.1f%% of the CPU" % (task, 100.0 * total / samples))
+        for name, count in sorted(functions.items(), key=lambda item: -item[1]):
+            print("  %6.1f%%  %6d  %s" % (100.0 * count / total, count, name))
+
+
+if __name__ == "__main__":
+    main()
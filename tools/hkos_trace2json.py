@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+###############################################################################
+#
+# This file is part of HalfKOS.
+# https://github.com/alairjunior/HalfKOS
+#
+# Copyright (c) 2025 Alair Dias Junior.
+#
+# HalfKOS is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# HalfKOS is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with HalfKOS.  If not, see <https://www.gnu.org/licenses/>.
+#
+###############################################################################
+"""
+Convert a HalfKOS trace stream (HKOS_TRACE_STREAM) to the Chrome trace JSON
+format, which can be opened in Perfetto (https://ui.perfetto.dev) or in
+chrome://tracing.
+
+The input is the raw byte stream received from the serial port, either read
+from a file or from the port itself (requires pyserial):
+
+    hkos_trace2json.py capture.bin -o trace.json
+    hkos_trace2json.py /dev/ttyACM0 --baud 9600 --seconds 10 -o trace.json
+
+Each task is shown as a thread named after its address, with a slice for
+every period it holds the CPU. Interrupts get a thread per vector.
+"""
+
+import argparse
+import json
+import sys
+
+FRAME_SIZE = 6
+FRAME_MARKER = 0xA0
+
+# Must match hkos_trace_event_t in src/core/hkos_trace.h
+(SYNC, SWITCH_OUT, SWITCH_IN, READY, BLOCK, MUTEX_LOCK, MUTEX_UNLOCK,
+ ISR_ENTER, ISR_EXIT, ALLOC, FREE, LOST) = range(12)
+
+EVENT_NAMES = {
+    READY: "ready",
+    BLOCK: "block",
+    MUTEX_LOCK: "mutex lock",
+    MUTEX_UNLOCK: "mutex unlock",
+    ALLOC: "alloc",
+    FREE: "free",
+}
+
+PID = 1
+KERNEL_TID = 0
+ISR_TID_BASE = 0x10000
+
+
+def read_frames(data):
+    """Yield (event, timestamp, arg) for each valid frame, resynchronizing
+    on the marker and checksum when bytes were corrupted or lost."""
+    i = 0
+    skipped = 0
+    while i + FRAME_SIZE <= len(data):
+        frame = data[i:i + FRAME_SIZE]
+        checksum = frame[0] ^ frame[1] ^ frame[2] ^ frame[3] ^ frame[4]
+        if (frame[0] & 0xF0) == FRAME_MARKER and checksum == frame[5]:
+            yield (frame[0] & 0x0F,
+                   frame[1] | (frame[2] << 8),
+                   frame[3] | (frame[4] << 8))
+            i += FRAME_SIZE
+        else:
+            i += 1
+            skipped += 1
+    if skipped:
+        print("skipped %d bytes while looking for frames" % skipped,
+              file=sys.stderr)
+
+
+class Clock:
+    """Extend the 16-bit timestamps to the time since HalfKOS started."""
+
+    def __init__(self, fractions):
+        self.fractions = fractions
+        self.last = None
+        self.time = 0
+
+    def update(self, timestamp):
+        if self.last is not None:
+            self.time += (timestamp - self.last) & 0xFFFF
+        self.last = timestamp
+        return self.time
+
+    def sync(self, timestamp, ticks):
+        # the record carries the lowest 16 bits of the tick counter
+        estimate = self.time // self.fractions
+        full = (estimate & ~0xFFFF) | ticks
+        if full < estimate:
+            full += 0x10000
+        base = full * self.fractions
+        self.time = base + ((timestamp - base) & 0xFFFF)
+        self.last = timestamp
+        return self.time
+
+
+def convert(frames, fractions, ticks_per_second):
+    us_per_fraction = 1e6 / (ticks_per_second * fractions)
+    clock = Clock(fractions)
+    events = []
+    names = {}
+    running = None
+    open_slices = set()
+    lost = 0
+
+    def thread(tid, name):
+        if tid not in names:
+            names[tid] = name
+        return tid
+
+    def task_tid(arg):
+        if arg == 0:
+            return thread(KERNEL_TID, "idle")
+        return thread(arg, "task 0x%04x" % arg)
+
+    def add(ph, tid, name, ts, args=None):
+        event = {"ph": ph, "pid": PID, "tid": tid, "name": name, "ts": ts}
+        if ph == "i":
+            event["s"] = "t"
+        if args:
+            event["args"] = args
+        events.append(event)
+
+    for event, timestamp, arg in frames:
+        if event == SYNC:
+            clock.sync(timestamp, arg)
+            continue
+
+        ts = clock.update(timestamp) * us_per_fraction
+
+        if event == SWITCH_OUT:
+            # the capture may start, or records may be lost, in a slice
+            if task_tid(arg) in open_slices:
+                add("E", task_tid(arg), "running", ts)
+                open_slices.discard(task_tid(arg))
+            running = None
+        elif event == SWITCH_IN:
+            add("B", task_tid(arg), "running", ts)
+            open_slices.add(task_tid(arg))
+            running = arg
+        elif event == ISR_ENTER:
+            add("B", thread(ISR_TID_BASE + arg, "ISR %d" % arg), "isr", ts)
+        elif event == ISR_EXIT:
+            add("E", thread(ISR_TID_BASE + arg, "ISR %d" % arg), "isr", ts)
+        elif event == LOST:
+            lost += arg
+            add("i", thread(KERNEL_TID, "idle"), "lost %d records" % arg, ts)
+        elif event in (READY, BLOCK):
+            add("i", task_tid(arg), EVENT_NAMES[event], ts)
+        elif event in EVENT_NAMES:
+            tid = task_tid(running) if running is not None else KERNEL_TID
+            add("i", tid, EVENT_NAMES[event], ts, {"address": "0x%04x" % arg})
+
+    for tid, name in names.items():
+        events.append({"ph": "M", "pid": PID, "tid": tid,
+                       "name": "thread_name", "args": {"name": name}})
+
+    if lost:
+        print("%d records were lost on the target" % lost, file=sys.stderr)
+
+    return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def capture(port, baud, seconds):
+    import time
+    import serial
+
+    data = bytearray()
+    with serial.Serial(port, baud, timeout=0.1) as link:
+        end = time.monotonic() + seconds
+        while time.monotonic() < end:
+            data += link.read(4096)
+    return bytes(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("input", help="capture file or serial port")
+    parser.add_argument("-o", "--output", default="-",
+                        help="output JSON file (default: stdout)")
+    parser.add_argument("--baud", type=int, default=9600,
+                        help="baud rate when reading from a serial port")
+    parser.add_argument("--seconds", type=float, default=10,
+                        help="capture time when reading from a serial port")
+    parser.add_argument("--fractions", type=int, default=2000,
+                        help="HKOS_HAL_TICK_FRACTIONS of the target")
+    parser.add_argument("--ticks-per-second", type=int, default=1000,
+                        help="HKOS_HAL_TICKS_IN_A_SECOND of the target")
+    args = parser.parse_args()
+
+    if args.input.startswith("/dev/") or args.input.upper().startswith("COM"):
+        data = capture(args.input, args.baud, args.seconds)
+    else:
+        with open(args.input, "rb") as capture_file:
+            data = capture_file.read()
+
+    trace = convert(read_frames(data), args.fractions, args.ticks_per_second)
+
+    if args.output == "-":
+        json.dump(trace, sys.stdout)
+    else:
+        with open(args.output, "w") as output:
+            json.dump(trace, output)
+
+
+if __name__ == "__main__":
+    main()